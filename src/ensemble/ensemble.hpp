@@ -0,0 +1,75 @@
+/**
+ * @file ensemble.hpp
+ * @brief Block rendering of voice ensembles for the Deep Note synthesizer
+ *
+ * This file provides entry points that render many DeepnoteVoice instances
+ * into a shared output block, so hosts don't each need their own loop around
+ * process_voice().
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "util/denormals.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <algorithm>
+
+namespace deepnote
+{
+
+/**
+ * @brief Render a block from a range of voices, summed into one buffer
+ *
+ * Voices are rendered one at a time across the whole block, which keeps each
+ * voice's state hot in cache. Denormals are flushed to zero for the duration
+ * of the render.
+ *
+ * @param first Iterator to the first voice
+ * @param last Iterator past the last voice
+ * @param out Destination for count samples, overwritten with the mix
+ * @param count Number of samples to render
+ * @param lfo_multiplier Speed multiplier for animation (1.0 = normal speed)
+ * @param cp1 First Bezier control point [0,1]
+ * @param cp2 Second Bezier control point [0,1]
+ */
+template <typename VoiceIterator>
+void process_ensemble_block(VoiceIterator first, const VoiceIterator last, float *out, const size_t count,
+                            const nt::AnimationMultiplier lfo_multiplier, const nt::ControlPoint1 cp1,
+                            const nt::ControlPoint2 cp2)
+{
+    const ScopedFlushDenormals flush_denormals;
+
+    std::fill(out, out + count, 0.f);
+    for(; first != last; ++first)
+    {
+        for(size_t i = 0; i < count; ++i)
+        {
+            out[i] += process_voice(*first, lfo_multiplier, cp1, cp2).get();
+        }
+    }
+}
+
+} // namespace deepnote
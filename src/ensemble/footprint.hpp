@@ -0,0 +1,108 @@
+/**
+ * @file footprint.hpp
+ * @brief Memory footprint of voices and ensembles
+ *
+ * This file provides footprint(), the bytes a voice or ensemble occupies
+ * together with the voices it renders, as a constant expression so a build
+ * can static_assert that a configuration fits its memory budget, and as
+ * plain values a host can log at runtime.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "ensemble/partitionedensemble.hpp"
+#include "ensemble/voicepool.hpp"
+#include <cstddef>
+
+namespace deepnote
+{
+namespace constants
+{
+//  AXI SRAM on the Daisy Seed's STM32H750, the largest block of internal RAM
+static constexpr size_t DAISY_SRAM_BYTES = 512 * 1024;
+//  L2 cache of one core of a current desktop CPU
+static constexpr size_t L2_CACHE_BYTES = 1024 * 1024;
+} // namespace constants
+
+/**
+ * @brief Bytes a type occupies together with the voices it renders
+ *
+ * The primary template describes a single voice. Ensembles specialise it:
+ * a VoicePool holds its voices inline, a PartitionedEnsemble points to
+ * voices held elsewhere, which are counted here as well.
+ */
+template <typename T> struct Footprint
+{
+    static constexpr size_t BYTES  = sizeof(T);
+    static constexpr size_t VOICES = 1;
+};
+
+template <size_t MaxVoices, typename Voice> struct Footprint<VoicePool<MaxVoices, Voice>>
+{
+    static constexpr size_t BYTES  = sizeof(VoicePool<MaxVoices, Voice>);
+    static constexpr size_t VOICES = MaxVoices;
+};
+
+template <size_t MaxVoices, typename Voice> struct Footprint<PartitionedEnsemble<MaxVoices, Voice>>
+{
+    static constexpr size_t BYTES  = sizeof(PartitionedEnsemble<MaxVoices, Voice>) + MaxVoices * sizeof(Voice);
+    static constexpr size_t VOICES = MaxVoices;
+};
+
+/**
+ * @brief Memory used by a voice or ensemble and what fits in a budget
+ */
+struct MemoryFootprint
+{
+    size_t bytes;
+    size_t voices;
+
+    constexpr size_t get_bytes_per_voice() const noexcept { return (bytes + voices - 1) / voices; }
+
+    /**
+     * @brief Number of voices that fit in a budget, as whole copies of the type
+     * @param budget Bytes available, e.g. constants::DAISY_SRAM_BYTES
+     */
+    constexpr size_t voices_in(const size_t budget) const noexcept { return budget / bytes * voices; }
+};
+
+/**
+ * @brief Footprint of a voice or ensemble type
+ *
+ * Usage:
+ * @code
+ * static_assert(deepnote::footprint<deepnote::BasicDeepnoteVoice<4>>().voices_in(
+ *                   deepnote::constants::DAISY_SRAM_BYTES) >= 2000,
+ *               "2000 voices no longer fit in SRAM");
+ * @endcode
+ */
+template <typename T> constexpr MemoryFootprint footprint() noexcept
+{
+    return MemoryFootprint{Footprint<T>::BYTES, Footprint<T>::VOICES};
+}
+
+} // namespace deepnote
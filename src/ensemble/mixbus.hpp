@@ -0,0 +1,274 @@
+/**
+ * @file mixbus.hpp
+ * @brief Stereo mix bus for Deep Note voice ensembles
+ *
+ * This file provides MixBus, which applies per-voice gain and constant-power
+ * pan to mono voice blocks and accumulates them into a stereo output, and
+ * process_ensemble_stereo_block(), which renders an ensemble through it.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "util/denormals.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace deepnote
+{
+namespace constants
+{
+//  Gain and pan changes are ramped over this many samples
+static constexpr uint32_t MIX_BUS_RAMP_SAMPLES = 64;
+//  Voices are rendered in chunks of this many samples before mixing
+static constexpr size_t MIX_BUS_CHUNK_SAMPLES = 64;
+} // namespace constants
+
+/**
+ * @brief Per-voice gain and constant-power pan into a stereo bus
+ *
+ * Each channel's left and right coefficients are precomputed when its gain
+ * or pan changes: left = gain * cos(θ), right = gain * sin(θ) with
+ * θ = (pan + 1) * π / 4, so a centred voice is 3dB down in each side and the
+ * total power doesn't depend on pan. Changes ramp linearly to the new
+ * coefficients over MIX_BUS_RAMP_SAMPLES samples, independent of block size.
+ *
+ * Mixing accumulates into the output, so clear it first. Outside of a ramp
+ * the inner loops are branchless multiply-adds that the compiler vectorizes.
+ *
+ * Channels start at unity gain, centred, with no ramp.
+ *
+ * @tparam MaxChannels Number of voice channels on the bus
+ */
+template <size_t MaxChannels> struct MixBus
+{
+    static_assert(MaxChannels > 0, "A mix bus needs at least one channel");
+
+    MixBus() noexcept
+    {
+        for(auto &channel : channels)
+        {
+            channel.set(1.f, 0.f);
+            channel.snap();
+        }
+    }
+
+    static constexpr size_t capacity() noexcept { return MaxChannels; }
+
+    /**
+     * @brief Set the linear gain of a channel, ramped
+     */
+    void set_gain(const size_t channel, const float gain)
+    {
+        auto &c = checked(channel);
+        c.set(gain, c.pan);
+    }
+
+    float get_gain(const size_t channel) const { return checked(channel).gain; }
+
+    /**
+     * @brief Set the pan of a channel, ramped
+     * @param pan -1 is hard left, 0 centre and 1 hard right; clamped to [-1,1]
+     */
+    void set_pan(const size_t channel, const float pan)
+    {
+        auto &c = checked(channel);
+        c.set(c.gain, std::min(std::max(pan, -1.f), 1.f));
+    }
+
+    float get_pan(const size_t channel) const { return checked(channel).pan; }
+
+    /**
+     * @brief Jump every channel to its target coefficients, e.g. before the first block
+     */
+    void snap() noexcept
+    {
+        for(auto &channel : channels)
+        {
+            channel.snap();
+        }
+    }
+
+    /**
+     * @brief Accumulate a mono block into planar stereo
+     * @param channel Channel whose gain and pan to apply
+     * @param in Mono samples
+     * @param count Number of samples
+     * @param left Left output, accumulated into
+     * @param right Right output, accumulated into
+     */
+    void mix(const size_t channel, const float *in, const size_t count, float *left, float *right)
+    {
+        mix_with(checked(channel), in, count, [left, right](const size_t i, const float l, const float r) {
+            left[i] += l;
+            right[i] += r;
+        });
+    }
+
+    /**
+     * @brief Accumulate a mono block into interleaved stereo
+     * @param channel Channel whose gain and pan to apply
+     * @param in Mono samples
+     * @param count Number of frames
+     * @param stereo Interleaved left/right output of 2 * count samples, accumulated into
+     */
+    void mix_interleaved(const size_t channel, const float *in, const size_t count, float *stereo)
+    {
+        mix_with(checked(channel), in, count, [stereo](const size_t i, const float l, const float r) {
+            stereo[2 * i] += l;
+            stereo[2 * i + 1] += r;
+        });
+    }
+
+  private:
+    struct Channel
+    {
+        void set(const float gain, const float pan) noexcept
+        {
+            const float theta = (pan + 1.f) * 0.785398163f;
+
+            this->gain   = gain;
+            this->pan    = pan;
+            target_left  = gain * std::cos(theta);
+            target_right = gain * std::sin(theta);
+            step_left    = (target_left - left) / constants::MIX_BUS_RAMP_SAMPLES;
+            step_right   = (target_right - right) / constants::MIX_BUS_RAMP_SAMPLES;
+            ramp         = constants::MIX_BUS_RAMP_SAMPLES;
+        }
+
+        void snap() noexcept
+        {
+            left  = target_left;
+            right = target_right;
+            ramp  = 0;
+        }
+
+        float    gain{1.f};
+        float    pan{0.f};
+        float    left{0.f};
+        float    right{0.f};
+        float    target_left{0.f};
+        float    target_right{0.f};
+        float    step_left{0.f};
+        float    step_right{0.f};
+        uint32_t ramp{0};
+    };
+
+    Channel &checked(const size_t channel)
+    {
+        if(channel >= MaxChannels)
+        {
+            throw std::invalid_argument("Mix bus channel out of range");
+        }
+        return channels[channel];
+    }
+
+    const Channel &checked(const size_t channel) const
+    {
+        if(channel >= MaxChannels)
+        {
+            throw std::invalid_argument("Mix bus channel out of range");
+        }
+        return channels[channel];
+    }
+
+    template <typename Store>
+    static void mix_with(Channel &channel, const float *in, const size_t count, const Store &store) noexcept
+    {
+        //  ramp, then a constant-coefficient loop with no per-sample branches
+        const size_t ramped = std::min(static_cast<size_t>(channel.ramp), count);
+        for(size_t i = 0; i < ramped; ++i)
+        {
+            channel.left += channel.step_left;
+            channel.right += channel.step_right;
+            store(i, in[i] * channel.left, in[i] * channel.right);
+        }
+        channel.ramp -= static_cast<uint32_t>(ramped);
+        if(channel.ramp == 0)
+        {
+            channel.snap();
+        }
+
+        const float left  = channel.left;
+        const float right = channel.right;
+        for(size_t i = ramped; i < count; ++i)
+        {
+            store(i, in[i] * left, in[i] * right);
+        }
+    }
+
+    std::array<Channel, MaxChannels> channels{};
+};
+
+/**
+ * @brief Render a block from a range of voices into planar stereo
+ *
+ * The voice at position n in the range is mixed through channel n of the bus.
+ * Voices are rendered in chunks of MIX_BUS_CHUNK_SAMPLES into a stack buffer
+ * so no allocation is needed. Denormals are flushed to zero for the duration
+ * of the render.
+ *
+ * @param first Iterator to the first voice
+ * @param last Iterator past the last voice, at most MaxChannels after first
+ * @param bus Mix bus holding each voice's gain and pan
+ * @param left Left output, overwritten with the mix
+ * @param right Right output, overwritten with the mix
+ * @param count Number of samples to render
+ * @param lfo_multiplier Speed multiplier for animation (1.0 = normal speed)
+ * @param cp1 First Bezier control point [0,1]
+ * @param cp2 Second Bezier control point [0,1]
+ */
+template <typename VoiceIterator, size_t MaxChannels>
+void process_ensemble_stereo_block(VoiceIterator first, const VoiceIterator last, MixBus<MaxChannels> &bus,
+                                   float *left, float *right, const size_t count,
+                                   const nt::AnimationMultiplier lfo_multiplier, const nt::ControlPoint1 cp1,
+                                   const nt::ControlPoint2 cp2)
+{
+    const ScopedFlushDenormals flush_denormals;
+
+    std::fill(left, left + count, 0.f);
+    std::fill(right, right + count, 0.f);
+
+    std::array<float, constants::MIX_BUS_CHUNK_SAMPLES> chunk;
+    for(size_t channel = 0; first != last; ++first, ++channel)
+    {
+        for(size_t offset = 0; offset < count; offset += chunk.size())
+        {
+            const size_t length = std::min(chunk.size(), count - offset);
+            for(size_t i = 0; i < length; ++i)
+            {
+                chunk[i] = process_voice(*first, lfo_multiplier, cp1, cp2).get();
+            }
+            bus.mix(channel, chunk.data(), length, left + offset, right + offset);
+        }
+    }
+}
+
+} // namespace deepnote
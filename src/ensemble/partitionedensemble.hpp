@@ -0,0 +1,279 @@
+/**
+ * @file partitionedensemble.hpp
+ * @brief Ensemble rendering with voices grouped by state
+ *
+ * This file provides PartitionedEnsemble, which keeps an ensemble's voices
+ * in contiguous pending, in-transit and at-target groups and renders each
+ * group with a kernel specialised for that state.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "util/denormals.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+
+namespace deepnote
+{
+
+/**
+ * @brief An ensemble of voices kept grouped by state
+ *
+ * The render order is a permutation of the voices split into three
+ * contiguous groups: pending, in transit and at target. Each group is
+ * rendered with its own kernel, so the state dispatch in process_voice()
+ * happens once per group rather than once per voice sample:
+ * - pending voices restart their LFO once and continue as in transit
+ * - voices in transit skip the steady-state and pending checks
+ * - voices at target run process_steady_oscillators() across the block
+ *
+ * A voice that changes state during a block finishes the block in the
+ * kernel for its new state and moves group afterwards with at most three
+ * swaps in the render order. The voices themselves never move, and every
+ * voice renders exactly the samples process_voice() would give it, so the
+ * mix matches process_ensemble_block() over the voices in render order.
+ *
+ * Voices are owned by the caller and referred to by the id add() returns.
+ * Retarget through set_target_frequency() so the voice moves to the
+ * pending group; after changing a voice's state any other way, call
+ * update_group() for it.
+ *
+ * @tparam MaxVoices Number of voices the ensemble can hold
+ * @tparam Voice Voice type, a BasicDeepnoteVoice
+ */
+template <size_t MaxVoices, typename Voice = DeepnoteVoice> class PartitionedEnsemble
+{
+    static_assert(MaxVoices > 0, "An ensemble needs at least one voice");
+    static_assert(MaxVoices < UINT16_MAX, "Voice ids are stored as uint16_t");
+
+  public:
+    PartitionedEnsemble() noexcept = default;
+
+    PartitionedEnsemble(const PartitionedEnsemble &other)            = delete;
+    PartitionedEnsemble &operator=(const PartitionedEnsemble &other) = delete;
+
+    /**
+     * @brief Add a voice in the group for its current state
+     * @param voice Voice to render, which must outlive the ensemble
+     * @return Id of the voice in the ensemble
+     */
+    size_t add(Voice &voice)
+    {
+        if(voice_count == MaxVoices)
+        {
+            throw std::invalid_argument("Ensemble is full");
+        }
+
+        //  join the at-target group at the end, then move across to the right group
+        const auto id      = static_cast<uint16_t>(voice_count);
+        voices[id]         = &voice;
+        order[voice_count] = id;
+        positions[id]      = id;
+        groups[id]         = DeepnoteVoiceBase::AT_TARGET;
+        ++voice_count;
+        move_to_group(id, voice.get_state());
+        return id;
+    }
+
+    Voice &get_voice(const size_t id) noexcept { return *voices[id]; }
+
+    size_t get_voice_count() const noexcept { return voice_count; }
+
+    static constexpr size_t capacity() noexcept { return MaxVoices; }
+
+    /**
+     * @brief Number of voices in the group for a state
+     */
+    size_t get_group_size(const DeepnoteVoiceBase::State state) const noexcept
+    {
+        switch(state)
+        {
+        case DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET:
+            return transit_begin;
+        case DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET:
+            return target_begin - transit_begin;
+        case DeepnoteVoiceBase::AT_TARGET:
+        default:
+            return voice_count - target_begin;
+        }
+    }
+
+    /**
+     * @brief Id of the voice at a position in render order
+     *
+     * Positions [0, pending) are pending, then in transit, then at target.
+     */
+    size_t get_id_at(const size_t position) const noexcept { return order[position]; }
+
+    /**
+     * @brief Retarget a voice, moving it to the pending group
+     */
+    void set_target_frequency(const size_t id, const nt::OscillatorFrequency freq)
+    {
+        voices[id]->set_target_frequency(freq);
+        move_to_group(static_cast<uint16_t>(id), voices[id]->get_state());
+    }
+
+    /**
+     * @brief Move a voice to the group for its current state
+     */
+    void update_group(const size_t id) noexcept
+    {
+        move_to_group(static_cast<uint16_t>(id), voices[id]->get_state());
+    }
+
+    /**
+     * @brief Render a block from every voice, summed into one buffer
+     *
+     * @param out Destination for count samples, overwritten with the mix
+     * @param count Number of samples to render
+     * @param lfo_multiplier Speed multiplier for animation (1.0 = normal speed)
+     * @param cp1 First Bezier control point [0,1]
+     * @param cp2 Second Bezier control point [0,1]
+     */
+    void process_block(float *out, const size_t count, const nt::AnimationMultiplier lfo_multiplier,
+                       const nt::ControlPoint1 cp1, const nt::ControlPoint2 cp2)
+    {
+        const ScopedFlushDenormals flush_denormals;
+
+        std::fill(out, out + count, 0.f);
+        if(count == 0)
+        {
+            return;
+        }
+
+        //  render in order without moving anything, then regroup the few
+        //  voices whose state changed
+        size_t moved_count{0};
+        for(size_t position = 0; position < transit_begin; ++position)
+        {
+            auto &voice = *voices[order[position]];
+            voice.reset_lfo();
+            out[0] += process_voice_in_transit(voice, DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET, lfo_multiplier,
+                                               cp1, cp2, NoopTrace())
+                          .get();
+            finish_block(voice, out, 1, count, lfo_multiplier, cp1, cp2);
+            moved[moved_count++] = order[position];
+        }
+        for(size_t position = transit_begin; position < target_begin; ++position)
+        {
+            auto &voice = *voices[order[position]];
+            if(finish_block(voice, out, 0, count, lfo_multiplier, cp1, cp2))
+            {
+                moved[moved_count++] = order[position];
+            }
+        }
+        for(size_t position = target_begin; position < voice_count; ++position)
+        {
+            render_at_target(*voices[order[position]], out, 0, count);
+        }
+
+        for(size_t m = 0; m < moved_count; ++m)
+        {
+            move_to_group(moved[m], voices[moved[m]]->get_state());
+        }
+    }
+
+  private:
+    //  Render samples [first, count) of a voice in transit, switching to the
+    //  at-target kernel if it arrives. Returns true if it arrived.
+    bool finish_block(Voice &voice, float *out, size_t first, const size_t count,
+                      const nt::AnimationMultiplier lfo_multiplier, const nt::ControlPoint1 cp1,
+                      const nt::ControlPoint2 cp2)
+    {
+        for(; first < count && !voice.is_at_target(); ++first)
+        {
+            out[first] += process_voice_in_transit(voice, DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET, lfo_multiplier,
+                                                   cp1, cp2, NoopTrace())
+                              .get();
+        }
+        if(!voice.is_at_target())
+        {
+            return false;
+        }
+        render_at_target(voice, out, first, count);
+        return true;
+    }
+
+    static void render_at_target(Voice &voice, float *out, size_t first, const size_t count)
+    {
+        if(first < count && !voice.is_steady_state())
+        {
+            out[first++] += process_voice_at_target(voice, NoopTrace()).get();
+        }
+        for(; first < count; ++first)
+        {
+            out[first] += voice.process_steady_oscillators().get();
+        }
+    }
+
+    void swap_positions(const size_t a, const size_t b) noexcept
+    {
+        std::swap(order[a], order[b]);
+        positions[order[a]] = static_cast<uint16_t>(a);
+        positions[order[b]] = static_cast<uint16_t>(b);
+    }
+
+    //  Each step moves a voice across one group boundary with one swap, the
+    //  boundary moving over it
+    void move_to_group(const uint16_t id, const DeepnoteVoiceBase::State state) noexcept
+    {
+        while(groups[id] != state)
+        {
+            const size_t position = positions[id];
+            if(groups[id] < state)
+            {
+                //  down a group: swap to the end of this group and shrink it
+                size_t &end = (groups[id] == DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET) ? transit_begin
+                                                                                            : target_begin;
+                swap_positions(position, --end);
+                groups[id] = static_cast<DeepnoteVoiceBase::State>(groups[id] + 1);
+            }
+            else
+            {
+                //  up a group: swap to the start of this group and grow the one before
+                size_t &begin = (groups[id] == DeepnoteVoiceBase::AT_TARGET) ? target_begin : transit_begin;
+                swap_positions(position, begin++);
+                groups[id] = static_cast<DeepnoteVoiceBase::State>(groups[id] - 1);
+            }
+        }
+    }
+
+    std::array<Voice *, MaxVoices>                  voices{};
+    std::array<uint16_t, MaxVoices>                 order{};
+    std::array<uint16_t, MaxVoices>                 positions{};
+    std::array<DeepnoteVoiceBase::State, MaxVoices> groups{};
+    std::array<uint16_t, MaxVoices>                 moved{};
+    size_t                                          voice_count{0};
+    size_t                                          transit_begin{0};
+    size_t                                          target_begin{0};
+};
+
+} // namespace deepnote
@@ -0,0 +1,431 @@
+/**
+ * @file rendergraph.hpp
+ * @brief Pull-based render graph for Deep Note voice ensembles
+ *
+ * This file provides RenderGraph, a fixed capacity graph of voices, mixers,
+ * taps and sinks. Sinks pull blocks through the graph, intermediate blocks
+ * live in a preallocated buffer pool and are reused as soon as their last
+ * consumer has read them, and nodes that don't feed a sink are never run.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "util/denormals.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+
+namespace deepnote
+{
+
+/**
+ * @brief Animation parameters shared by every voice in a graph for a block
+ */
+struct BlockParameters
+{
+    nt::AnimationMultiplier lfo_multiplier;
+    nt::ControlPoint1       cp1;
+    nt::ControlPoint2       cp2;
+};
+
+/**
+ * @brief The input blocks of a node, in the order the inputs were given
+ */
+struct NodeInputs
+{
+    const float *const *buffers;
+    const float        *gains;
+    size_t              count;
+};
+
+/**
+ * @brief Fixed capacity pull-based render graph
+ *
+ * Nodes are added with their inputs, which must already exist, so the graph
+ * is acyclic by construction and insertion order is a valid render order.
+ * Before the first process() after a change the graph works out which nodes
+ * feed a sink and how many buffers their blocks need at once; if the pool is
+ * too small, process() throws std::invalid_argument rather than allocating.
+ *
+ * Node types:
+ * - add_voice(): renders a voice with process_voice()
+ * - add_mixer(): sums its inputs, each with a gain
+ * - add_tap(): passes its input through and shows it to a functor, e.g. for tracing
+ * - add_node(): any functor (const BlockParameters &, const NodeInputs &, float *out, size_t count)
+ * - add_sink(): copies its input to a host buffer
+ *
+ * Voices, taps and custom nodes are referenced, not owned, and must outlive
+ * the graph.
+ *
+ * @tparam MaxNodes Node capacity
+ * @tparam MaxEdges Capacity for inputs, summed over all nodes
+ * @tparam MaxBuffers Number of pooled blocks
+ * @tparam BlockSize Samples per pooled block; process() renders longer requests in pieces
+ */
+template <size_t MaxNodes, size_t MaxEdges, size_t MaxBuffers, size_t BlockSize = 64> struct RenderGraph
+{
+    using NodeId = size_t;
+
+    RenderGraph() = default;
+
+    RenderGraph(const RenderGraph &other)            = delete;
+    RenderGraph &operator=(const RenderGraph &other) = delete;
+
+    template <typename Voice> NodeId add_voice(Voice &voice)
+    {
+        return add(&render_voice<Voice>, &voice, {});
+    }
+
+    NodeId add_mixer(std::initializer_list<NodeId> inputs) { return add(&render_mixer, nullptr, inputs); }
+
+    NodeId add_mixer(const NodeId *inputs, const size_t count)
+    {
+        return add(&render_mixer, nullptr, inputs, count);
+    }
+
+    template <typename Tap> NodeId add_tap(const NodeId input, Tap &tap)
+    {
+        return add(&render_tap<Tap>, &tap, {input});
+    }
+
+    template <typename Processor> NodeId add_node(Processor &processor, std::initializer_list<NodeId> inputs)
+    {
+        return add(&render_processor<Processor>, &processor, inputs);
+    }
+
+    /**
+     * @brief Add a sink that copies its input to a host buffer
+     * @param input Node to pull from
+     * @param out Host buffer, at least as long as the largest process() request
+     * @throws std::invalid_argument if out is null
+     */
+    NodeId add_sink(const NodeId input, float *out)
+    {
+        if(out == nullptr)
+        {
+            throw std::invalid_argument("Render graph sink needs a buffer");
+        }
+        const auto id  = add(&render_sink, nullptr, {input});
+        nodes[id].sink = out;
+        return id;
+    }
+
+    /**
+     * @brief Set the gain a mixer applies to one of its inputs
+     * @param node Mixer
+     * @param input Position of the input in the list the mixer was added with
+     * @param gain Linear gain
+     */
+    void set_input_gain(const NodeId node, const size_t input, const float gain)
+    {
+        if(node >= node_count || input >= nodes[node].input_count)
+        {
+            throw std::invalid_argument("Render graph input out of range");
+        }
+        edge_gains[nodes[node].first_input + input] = gain;
+    }
+
+    /**
+     * @brief Redirect a sink, e.g. to the host's buffer for this callback
+     * @throws std::invalid_argument if the node is not a sink or out is null
+     */
+    void set_sink_buffer(const NodeId sink, float *out)
+    {
+        if(sink >= node_count || nodes[sink].sink == nullptr)
+        {
+            throw std::invalid_argument("Render graph node is not a sink");
+        }
+        if(out == nullptr)
+        {
+            throw std::invalid_argument("Render graph sink needs a buffer");
+        }
+        nodes[sink].sink = out;
+    }
+
+    void set_parameters(const BlockParameters &parameters) noexcept { this->parameters = parameters; }
+
+    const BlockParameters &get_parameters() const noexcept { return parameters; }
+
+    size_t get_node_count() const noexcept { return node_count; }
+
+    /**
+     * @brief Whether a node feeds a sink and is therefore rendered
+     */
+    bool is_active(const NodeId node)
+    {
+        prepare();
+        return node < node_count && active[node];
+    }
+
+    /**
+     * @brief Most pooled buffers in use at once while rendering the graph
+     */
+    size_t get_peak_buffers()
+    {
+        prepare();
+        return peak_buffers;
+    }
+
+    /**
+     * @brief Render count samples into every sink
+     *
+     * Denormals are flushed to zero for the duration of the render.
+     */
+    void process(const size_t count)
+    {
+        prepare();
+        const ScopedFlushDenormals flush_denormals;
+
+        for(size_t offset = 0; offset < count; offset += BlockSize)
+        {
+            process_block(offset, std::min(BlockSize, count - offset));
+        }
+    }
+
+  private:
+    using RenderFunction = void (*)(void *context, const BlockParameters &parameters, const NodeInputs &inputs,
+                                    float *out, size_t count);
+
+    static_assert(MaxBuffers <= UINT16_MAX, "Buffer indices are stored as uint16_t");
+
+    struct Node
+    {
+        RenderFunction render;
+        void          *context;
+        size_t         first_input;
+        size_t         input_count;
+        float         *sink;
+    };
+
+    NodeId add(const RenderFunction render, void *context, std::initializer_list<NodeId> inputs)
+    {
+        return add(render, context, inputs.begin(), inputs.size());
+    }
+
+    NodeId add(const RenderFunction render, void *context, const NodeId *inputs, const size_t count)
+    {
+        if(node_count >= MaxNodes)
+        {
+            throw std::invalid_argument("Render graph node capacity exceeded");
+        }
+        if(edge_count + count > MaxEdges)
+        {
+            throw std::invalid_argument("Render graph input capacity exceeded");
+        }
+        for(size_t i = 0; i < count; ++i)
+        {
+            if(inputs[i] >= node_count || nodes[inputs[i]].sink != nullptr)
+            {
+                throw std::invalid_argument("Render graph input must be an existing non-sink node");
+            }
+        }
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            edges[edge_count + i]      = inputs[i];
+            edge_gains[edge_count + i] = 1.f;
+        }
+        nodes[node_count] = Node{render, context, edge_count, count, nullptr};
+        edge_count += count;
+        prepared = false;
+        return node_count++;
+    }
+
+    //  Work out which nodes are reachable from a sink, how many reachable nodes
+    //  read each one, and how many buffers rendering needs at most
+    void prepare()
+    {
+        if(prepared)
+        {
+            return;
+        }
+
+        //  inputs always precede their consumers, so one reverse pass finds everything a sink pulls on
+        for(NodeId id = 0; id < node_count; ++id)
+        {
+            active[id]    = nodes[id].sink != nullptr;
+            consumers[id] = 0;
+        }
+        for(NodeId id = node_count; id-- > 0;)
+        {
+            if(!active[id])
+            {
+                continue;
+            }
+            for(size_t e = nodes[id].first_input; e < nodes[id].first_input + nodes[id].input_count; ++e)
+            {
+                active[edges[e]] = true;
+                ++consumers[edges[e]];
+            }
+        }
+
+        //  dry run of the buffer lifetimes
+        size_t in_use{0};
+        peak_buffers = 0;
+        remaining    = consumers;
+        for(NodeId id = 0; id < node_count; ++id)
+        {
+            if(!active[id])
+            {
+                continue;
+            }
+            if(nodes[id].sink == nullptr)
+            {
+                peak_buffers = std::max(peak_buffers, ++in_use);
+            }
+            for(size_t e = nodes[id].first_input; e < nodes[id].first_input + nodes[id].input_count; ++e)
+            {
+                in_use -= (--remaining[edges[e]] == 0) ? 1 : 0;
+            }
+        }
+        if(peak_buffers > MaxBuffers)
+        {
+            throw std::invalid_argument("Render graph needs " + std::to_string(peak_buffers) +
+                                        " buffers, pool holds " + std::to_string(MaxBuffers));
+        }
+
+        prepared = true;
+    }
+
+    void process_block(const size_t offset, const size_t count)
+    {
+        free_count = MaxBuffers;
+        for(size_t i = 0; i < MaxBuffers; ++i)
+        {
+            free_buffers[i] = static_cast<uint16_t>(MaxBuffers - 1 - i);
+        }
+        remaining = consumers;
+
+        for(NodeId id = 0; id < node_count; ++id)
+        {
+            if(!active[id])
+            {
+                continue;
+            }
+
+            const Node &node = nodes[id];
+            for(size_t i = 0; i < node.input_count; ++i)
+            {
+                input_buffers[i] = pool[buffer_of[edges[node.first_input + i]]].data();
+            }
+
+            float *out{nullptr};
+            if(node.sink != nullptr)
+            {
+                out = node.sink + offset;
+            }
+            else
+            {
+                buffer_of[id] = free_buffers[--free_count];
+                out           = pool[buffer_of[id]].data();
+            }
+
+            const NodeInputs inputs{input_buffers.data(), edge_gains.data() + node.first_input, node.input_count};
+            node.render(node.context, parameters, inputs, out, count);
+
+            for(size_t e = node.first_input; e < node.first_input + node.input_count; ++e)
+            {
+                if(--remaining[edges[e]] == 0)
+                {
+                    free_buffers[free_count++] = buffer_of[edges[e]];
+                }
+            }
+        }
+    }
+
+    template <typename Voice>
+    static void render_voice(void *context, const BlockParameters &parameters, const NodeInputs &inputs, float *out,
+                             const size_t count)
+    {
+        auto &voice = *static_cast<Voice *>(context);
+        for(size_t i = 0; i < count; ++i)
+        {
+            out[i] = process_voice(voice, parameters.lfo_multiplier, parameters.cp1, parameters.cp2).get();
+        }
+    }
+
+    static void render_mixer(void *context, const BlockParameters &parameters, const NodeInputs &inputs, float *out,
+                             const size_t count)
+    {
+        std::fill(out, out + count, 0.f);
+        for(size_t input = 0; input < inputs.count; ++input)
+        {
+            const float *in   = inputs.buffers[input];
+            const float  gain = inputs.gains[input];
+            for(size_t i = 0; i < count; ++i)
+            {
+                out[i] += in[i] * gain;
+            }
+        }
+    }
+
+    template <typename Tap>
+    static void render_tap(void *context, const BlockParameters &parameters, const NodeInputs &inputs, float *out,
+                           const size_t count)
+    {
+        (*static_cast<Tap *>(context))(inputs.buffers[0], count);
+        std::copy(inputs.buffers[0], inputs.buffers[0] + count, out);
+    }
+
+    template <typename Processor>
+    static void render_processor(void *context, const BlockParameters &parameters, const NodeInputs &inputs,
+                                 float *out, const size_t count)
+    {
+        (*static_cast<Processor *>(context))(parameters, inputs, out, count);
+    }
+
+    static void render_sink(void *context, const BlockParameters &parameters, const NodeInputs &inputs, float *out,
+                            const size_t count)
+    {
+        std::copy(inputs.buffers[0], inputs.buffers[0] + count, out);
+    }
+
+    BlockParameters parameters{nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.f), nt::ControlPoint2(1.f)};
+
+    std::array<Node, MaxNodes>     nodes{};
+    size_t                         node_count{0};
+    std::array<NodeId, MaxEdges>   edges{};
+    std::array<float, MaxEdges>    edge_gains{};
+    size_t                         edge_count{0};
+    std::array<bool, MaxNodes>     active{};
+    std::array<size_t, MaxNodes>   consumers{};
+    std::array<size_t, MaxNodes>   remaining{};
+    std::array<uint16_t, MaxNodes> buffer_of{};
+    bool                           prepared{false};
+    size_t                         peak_buffers{0};
+
+    std::array<std::array<float, BlockSize>, MaxBuffers> pool{};
+    std::array<uint16_t, MaxBuffers>                     free_buffers{};
+    size_t                                               free_count{0};
+    std::array<const float *, MaxEdges>                  input_buffers{};
+};
+
+} // namespace deepnote
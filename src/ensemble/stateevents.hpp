@@ -0,0 +1,124 @@
+/**
+ * @file stateevents.hpp
+ * @brief Voice state change notifications for the Deep Note synthesizer
+ *
+ * This file provides StateEventTrace, a trace functor for process_voice()
+ * and process_voice_block() that posts an event to a wait-free queue each
+ * time a voice changes state, so control threads can react to voices
+ * reaching their targets without polling every voice.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "util/spscqueue.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace deepnote
+{
+namespace constants
+{
+static constexpr size_t DEFAULT_STATE_EVENT_CAPACITY = 256;
+} // namespace constants
+
+/**
+ * @brief A voice changed state while rendering
+ */
+struct StateEvent
+{
+    uint64_t                 sample_position; //  sample at which the voice entered the state
+    uint32_t                 voice_id;        //  chosen by the host, e.g. the voice's index
+    DeepnoteVoiceBase::State state;           //  state the voice entered
+};
+
+template <size_t Capacity = constants::DEFAULT_STATE_EVENT_CAPACITY>
+using StateEventQueue = SpscQueue<StateEvent, Capacity>;
+
+/**
+ * @brief Trace functor that posts a StateEvent whenever a voice changes state
+ *
+ * process_voice() calls its trace functor once per sample with the state the
+ * voice had on entry and the state it leaves in. This functor counts samples
+ * from a starting position and posts an event when the two differ: the
+ * render path moving a voice into transit and on to its target. Changes the
+ * host makes itself, such as retargeting, are not posted. Works with the
+ * float and fixed-point voices.
+ *
+ * Usage:
+ * @code
+ * deepnote::StateEventQueue<> events;
+ *
+ * //  audio thread
+ * process_voice_block(voice, out, count, multiplier, cp1, cp2,
+ *                     deepnote::make_state_event_trace(events, voice_id, block_start));
+ *
+ * //  control thread
+ * deepnote::StateEvent event;
+ * while(events.try_pop(event)) { ... }
+ * @endcode
+ *
+ * @tparam Queue Queue of StateEvent with try_push(), e.g. StateEventQueue
+ */
+template <typename Queue> struct StateEventTrace
+{
+    StateEventTrace(Queue &queue, const uint32_t voice_id, const uint64_t sample_position) noexcept
+        : queue(&queue)
+        , voice_id(voice_id)
+        , sample_position(sample_position)
+    {
+    }
+
+    template <typename Frequency, typename... Rest>
+    void operator()(Frequency, Frequency, const DeepnoteVoiceBase::State in_state,
+                    const DeepnoteVoiceBase::State state, Rest...) const noexcept
+    {
+        if(in_state != state)
+        {
+            queue->try_push(StateEvent{sample_position, voice_id, state});
+        }
+        ++sample_position;
+    }
+
+    /**
+     * @brief Position of the next sample to be rendered
+     */
+    uint64_t get_sample_position() const noexcept { return sample_position; }
+
+  private:
+    Queue           *queue;
+    uint32_t         voice_id;
+    mutable uint64_t sample_position;
+};
+
+template <typename Queue>
+StateEventTrace<Queue> make_state_event_trace(Queue &queue, const uint32_t voice_id, const uint64_t sample_position)
+{
+    return StateEventTrace<Queue>(queue, voice_id, sample_position);
+}
+
+} // namespace deepnote
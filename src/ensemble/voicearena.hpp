@@ -0,0 +1,280 @@
+/**
+ * @file voicearena.hpp
+ * @brief Cache-line-aligned arena for large voice ensembles
+ *
+ * This file provides VoiceArena, which constructs voices contiguously in a
+ * single allocation with every voice starting on its own cache line, split
+ * into padded partitions so that worker threads rendering neighbouring
+ * partitions never write to the same line.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "util/cacheline.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace deepnote
+{
+namespace constants
+{
+//  Two lines, since adjacent-line prefetchers pull cache lines in pairs
+static constexpr size_t ARENA_PARTITION_PADDING = 2 * CACHE_LINE_SIZE;
+static constexpr size_t HUGE_PAGE_SIZE          = 2 * 1024 * 1024;
+} // namespace constants
+
+/**
+ * @brief Fixed set of voices in one cache-line-aligned allocation
+ *
+ * Voices are stored at a stride of sizeof(Voice) rounded up to a cache line,
+ * so no two voices share a line, and each partition is followed by
+ * ARENA_PARTITION_PADDING bytes so the next partition starts clear of
+ * prefetch pairs. Give each worker thread its own partition.
+ *
+ * With HUGE_PAGES on Linux the arena is mapped separately, aligned to a huge
+ * page and advised for transparent huge pages, which reduces TLB misses when
+ * thousands of voices are rendered each block. Elsewhere standard pages are
+ * used. is_huge_page_advised() reports whether the kernel accepted the
+ * advice; whether it actually backs the arena with huge pages is up to its
+ * THP policy and free memory, see AnonHugePages in /proc/self/smaps.
+ *
+ * Voices are default constructed when the arena is created and destroyed
+ * with it, and never move.
+ *
+ * @tparam Voice Voice type stored in the arena
+ */
+template <typename Voice = DeepnoteVoice> struct VoiceArena
+{
+    enum PageMode
+    {
+        STANDARD_PAGES,
+        HUGE_PAGES
+    };
+
+    /**
+     * @brief Iterates over the voices of one partition
+     */
+    struct Iterator
+    {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Voice;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = Voice *;
+        using reference         = Voice &;
+
+        Voice &operator*() const noexcept { return *reinterpret_cast<Voice *>(position); }
+        Voice *operator->() const noexcept { return reinterpret_cast<Voice *>(position); }
+
+        Iterator &operator++() noexcept
+        {
+            position += VOICE_STRIDE;
+            return *this;
+        }
+
+        bool operator==(const Iterator &other) const noexcept { return position == other.position; }
+        bool operator!=(const Iterator &other) const noexcept { return position != other.position; }
+
+        unsigned char *position;
+    };
+
+    struct Partition
+    {
+        Iterator begin() const noexcept { return first; }
+        Iterator end() const noexcept { return last; }
+        size_t   size() const noexcept { return (last.position - first.position) / VOICE_STRIDE; }
+
+        Iterator first;
+        Iterator last;
+    };
+
+    /**
+     * @param partitions Number of partitions, usually one per worker thread
+     * @param voices_per_partition Voices in each partition
+     * @param page_mode Whether to request huge pages
+     * @throws std::invalid_argument if the arena would be empty
+     * @throws std::bad_alloc if the memory can't be reserved
+     */
+    VoiceArena(const size_t partitions, const size_t voices_per_partition, const PageMode page_mode = STANDARD_PAGES)
+        : partition_count(partitions)
+        , voices_per_partition(voices_per_partition)
+        , partition_stride(voices_per_partition * VOICE_STRIDE + constants::ARENA_PARTITION_PADDING)
+    {
+        if(partitions == 0 || voices_per_partition == 0)
+        {
+            throw std::invalid_argument("Voice arena must hold at least one voice");
+        }
+
+        reserve(partitions * partition_stride, page_mode);
+
+        for(size_t p = 0; p < partition_count; ++p)
+        {
+            for(auto &slot : partition(p))
+            {
+                new(&slot) Voice();
+            }
+        }
+    }
+
+    ~VoiceArena()
+    {
+        for(size_t p = 0; p < partition_count; ++p)
+        {
+            for(auto &voice : partition(p))
+            {
+                voice.~Voice();
+            }
+        }
+        release();
+    }
+
+    VoiceArena(const VoiceArena &other)            = delete;
+    VoiceArena &operator=(const VoiceArena &other) = delete;
+
+    Partition partition(const size_t index) const
+    {
+        if(index >= partition_count)
+        {
+            throw std::invalid_argument("Voice arena partition out of range");
+        }
+        unsigned char *first = base + index * partition_stride;
+        return Partition{Iterator{first}, Iterator{first + voices_per_partition * VOICE_STRIDE}};
+    }
+
+    /**
+     * @brief Voice by position across all partitions
+     */
+    Voice &operator[](const size_t index) const noexcept
+    {
+        const size_t p = index / voices_per_partition;
+        const size_t v = index % voices_per_partition;
+        return *reinterpret_cast<Voice *>(base + p * partition_stride + v * VOICE_STRIDE);
+    }
+
+    size_t get_partition_count() const noexcept { return partition_count; }
+    size_t get_voice_count() const noexcept { return partition_count * voices_per_partition; }
+
+    //  Bytes between consecutive voices
+    static constexpr size_t get_voice_stride() noexcept { return VOICE_STRIDE; }
+
+    //  Bytes occupied by voices, including rounding each up to a cache line
+    size_t get_voice_bytes() const noexcept { return get_voice_count() * VOICE_STRIDE; }
+
+    //  Bytes spent on padding: per-voice rounding plus partition separators
+    size_t get_padding_bytes() const noexcept
+    {
+        return get_voice_count() * (VOICE_STRIDE - sizeof(Voice)) +
+               partition_count * constants::ARENA_PARTITION_PADDING;
+    }
+
+    //  Bytes reserved from the system, including alignment and page rounding
+    size_t get_reserved_bytes() const noexcept { return reserved_bytes; }
+
+    //  True if the arena was advised for transparent huge pages and the kernel accepted
+    bool is_huge_page_advised() const noexcept { return huge_pages; }
+
+  private:
+    static constexpr size_t VOICE_STRIDE =
+        (sizeof(Voice) + constants::CACHE_LINE_SIZE - 1) / constants::CACHE_LINE_SIZE * constants::CACHE_LINE_SIZE;
+
+    static_assert(alignof(Voice) <= constants::CACHE_LINE_SIZE, "Voice alignment exceeds a cache line");
+
+    void reserve(const size_t bytes, const PageMode page_mode)
+    {
+#if defined(__linux__)
+        if(page_mode == HUGE_PAGES)
+        {
+            //  mmap only aligns to a standard page and huge pages can only back
+            //  aligned extents, so map a huge page extra and unmap the slack
+            const size_t mapped = (bytes + constants::HUGE_PAGE_SIZE - 1) / constants::HUGE_PAGE_SIZE *
+                                  constants::HUGE_PAGE_SIZE;
+            void *region = mmap(nullptr, mapped + constants::HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(region == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+            const uintptr_t start   = reinterpret_cast<uintptr_t>(region);
+            const uintptr_t aligned = (start + constants::HUGE_PAGE_SIZE - 1) & ~(constants::HUGE_PAGE_SIZE - 1);
+            if(aligned > start)
+            {
+                munmap(region, aligned - start);
+            }
+            munmap(reinterpret_cast<void *>(aligned + mapped), constants::HUGE_PAGE_SIZE - (aligned - start));
+            region = reinterpret_cast<void *>(aligned);
+#if defined(MADV_HUGEPAGE)
+            huge_pages = madvise(region, mapped, MADV_HUGEPAGE) == 0;
+#endif
+            allocation     = region;
+            base           = static_cast<unsigned char *>(region);
+            reserved_bytes = mapped;
+            mapped_region  = true;
+            return;
+        }
+#endif
+        (void)page_mode;
+
+        reserved_bytes = bytes + constants::CACHE_LINE_SIZE - 1;
+        allocation     = ::operator new(reserved_bytes);
+        void  *aligned = allocation;
+        size_t space   = reserved_bytes;
+        base           = static_cast<unsigned char *>(std::align(constants::CACHE_LINE_SIZE, bytes, aligned, space));
+    }
+
+    void release() noexcept
+    {
+#if defined(__linux__)
+        if(mapped_region)
+        {
+            munmap(allocation, reserved_bytes);
+            return;
+        }
+#endif
+        ::operator delete(allocation);
+    }
+
+    size_t         partition_count;
+    size_t         voices_per_partition;
+    size_t         partition_stride;
+    void          *allocation{nullptr};
+    unsigned char *base{nullptr};
+    size_t         reserved_bytes{0};
+    bool           huge_pages{false};
+    bool           mapped_region{false};
+};
+
+template <typename Voice> constexpr size_t VoiceArena<Voice>::VOICE_STRIDE;
+
+} // namespace deepnote
@@ -0,0 +1,357 @@
+/**
+ * @file voicepool.hpp
+ * @brief Polyphonic voice allocation for the Deep Note synthesizer
+ *
+ * This file provides VoicePool, a fixed capacity pool of voices with O(1)
+ * allocation and release, configurable voice stealing, and rendering that only
+ * touches active voices.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "ensemble/stateevents.hpp"
+#include "util/denormals.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+
+namespace deepnote
+{
+
+/**
+ * @brief Fixed capacity pool of voices with O(1) allocation and voice stealing
+ *
+ * Free voices are kept on an intrusive singly linked free list, and active
+ * voices in a dense array, so allocation, release and iteration never scan
+ * idle voices. When every voice is active, allocate() steals one according to
+ * the steal policy:
+ * - STEAL_OLDEST: the voice allocated longest ago
+ * - STEAL_QUIETEST: the voice with the lowest peak level in the last rendered block
+ * - STEAL_CLOSEST_TO_TARGET: the voice with the least of its transit remaining,
+ *   voices already at target first
+ *
+ * Allocated and stolen voices are returned as-is; initialise them with
+ * init_voice() before use. Pointers to voices stay valid for the lifetime of
+ * the pool. Iteration order over active voices is unspecified and changes on
+ * release.
+ *
+ * @tparam MaxVoices Number of voices in the pool
+ * @tparam Voice Voice type, DeepnoteVoice by default
+ */
+template <size_t MaxVoices, typename Voice = DeepnoteVoice> struct VoicePool
+{
+    static_assert(MaxVoices > 0, "A voice pool needs at least one voice");
+    static_assert(MaxVoices < UINT16_MAX, "Voice indices are stored as uint16_t");
+
+    enum StealPolicy
+    {
+        STEAL_OLDEST,
+        STEAL_QUIETEST,
+        STEAL_CLOSEST_TO_TARGET
+    };
+
+    struct ActiveIterator
+    {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Voice;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = Voice *;
+        using reference         = Voice &;
+
+        Voice &operator*() const noexcept { return pool->voices[*position]; }
+
+        Voice *operator->() const noexcept { return &pool->voices[*position]; }
+
+        ActiveIterator &operator++() noexcept
+        {
+            ++position;
+            return *this;
+        }
+
+        bool operator==(const ActiveIterator &rhs) const noexcept { return position == rhs.position; }
+
+        bool operator!=(const ActiveIterator &rhs) const noexcept { return position != rhs.position; }
+
+        VoicePool      *pool;
+        const uint16_t *position;
+    };
+
+    VoicePool() noexcept
+    {
+        for(size_t i = 0; i < MaxVoices; ++i)
+        {
+            slots[i].next_free = (i + 1 < MaxVoices) ? static_cast<uint16_t>(i + 1) : NONE;
+        }
+    }
+
+    VoicePool(const VoicePool &other)            = delete;
+    VoicePool &operator=(const VoicePool &other) = delete;
+
+    void set_steal_policy(const StealPolicy policy) noexcept { steal_policy = policy; }
+
+    StealPolicy get_steal_policy() const noexcept { return steal_policy; }
+
+    /**
+     * @brief Take a voice from the pool, stealing one if none are free
+     * @return Voice to initialise; never nullptr
+     */
+    Voice *allocate() noexcept
+    {
+        uint16_t index;
+        if(first_free != NONE)
+        {
+            index      = first_free;
+            first_free = slots[index].next_free;
+
+            slots[index].active_position = static_cast<uint16_t>(active_count);
+            active[active_count++]       = index;
+        }
+        else
+        {
+            index = select_victim();
+        }
+
+        slots[index].allocation_order = next_allocation_order++;
+        slots[index].level            = 0.f;
+        return &voices[index];
+    }
+
+    /**
+     * @brief Return a voice to the pool
+     * @param voice Voice previously returned by allocate(); ignored if not active
+     */
+    void release(const Voice *voice) noexcept
+    {
+        const auto index = index_of(voice);
+        if(index >= MaxVoices || !slots[index].is_active())
+        {
+            return;
+        }
+
+        //  swap-remove from the dense active list
+        const uint16_t position      = slots[index].active_position;
+        const uint16_t moved         = active[--active_count];
+        active[position]             = moved;
+        slots[moved].active_position = position;
+        slots[index].active_position = NONE;
+        slots[index].next_free       = first_free;
+        first_free                   = static_cast<uint16_t>(index);
+    }
+
+    bool is_active(const Voice *voice) const noexcept
+    {
+        const auto index = index_of(voice);
+        return index < MaxVoices && slots[index].is_active();
+    }
+
+    size_t get_active_count() const noexcept { return active_count; }
+
+    static constexpr size_t capacity() noexcept { return MaxVoices; }
+
+    ActiveIterator begin() noexcept { return ActiveIterator{this, active.data()}; }
+
+    ActiveIterator end() noexcept { return ActiveIterator{this, active.data() + active_count}; }
+
+    /**
+     * @brief Peak absolute output of a voice over the last process_block()
+     * @return The level, or 0 for a voice the pool doesn't own
+     */
+    float get_level(const Voice *voice) const noexcept
+    {
+        const auto index = index_of(voice);
+        return (index < MaxVoices) ? slots[index].level : 0.f;
+    }
+
+    /**
+     * @brief Index of a voice in the pool, the voice_id of its StateEvents
+     */
+    size_t get_index(const Voice *voice) const noexcept { return index_of(voice); }
+
+    /**
+     * @brief Voice at an index, e.g. the voice_id of a StateEvent
+     */
+    Voice &get_voice(const size_t index) noexcept { return voices[index]; }
+
+    /**
+     * @brief Number of samples rendered by process_block() so far
+     */
+    uint64_t get_sample_position() const noexcept { return sample_position; }
+
+    /**
+     * @brief Render a block from the active voices, summed into one buffer
+     *
+     * Behaves as process_ensemble_block() over the active voices, and records
+     * each voice's peak level for STEAL_QUIETEST.
+     *
+     * @param out Destination for count samples, overwritten with the mix
+     * @param count Number of samples to render
+     * @param lfo_multiplier Speed multiplier for animation (1.0 = normal speed)
+     * @param cp1 First Bezier control point [0,1]
+     * @param cp2 Second Bezier control point [0,1]
+     */
+    void process_block(float *out, const size_t count, const nt::AnimationMultiplier lfo_multiplier,
+                       const nt::ControlPoint1 cp1, const nt::ControlPoint2 cp2)
+    {
+        render_block(out, count, lfo_multiplier, cp1, cp2, [](uint16_t) { return NoopTrace(); });
+    }
+
+    /**
+     * @brief Render a block, posting voice state changes to a queue
+     *
+     * As process_block(), and every state change the render makes is posted
+     * to events as a StateEvent whose voice_id is the voice's index and whose
+     * position counts samples rendered by the pool. Events are posted voice
+     * by voice, so within a block they are grouped by voice rather than
+     * ordered by position. Call from the queue's producer thread.
+     *
+     * @param events Queue of StateEvent, e.g. StateEventQueue
+     */
+    template <typename Queue>
+    void process_block(float *out, const size_t count, const nt::AnimationMultiplier lfo_multiplier,
+                       const nt::ControlPoint1 cp1, const nt::ControlPoint2 cp2, Queue &events)
+    {
+        render_block(out, count, lfo_multiplier, cp1, cp2, [&](const uint16_t index) {
+            return make_state_event_trace(events, index, sample_position);
+        });
+    }
+
+  private:
+    static constexpr uint16_t NONE = UINT16_MAX;
+
+    //  Bookkeeping is kept apart from the voices so the steal scan and free
+    //  list don't pull voice state into cache
+    struct Slot
+    {
+        bool is_active() const noexcept { return active_position != NONE; }
+
+        uint64_t allocation_order{0};
+        float    level{0.f};
+        uint16_t next_free{NONE};
+        uint16_t active_position{NONE};
+    };
+
+    template <typename MakeTrace>
+    void render_block(float *out, const size_t count, const nt::AnimationMultiplier lfo_multiplier,
+                      const nt::ControlPoint1 cp1, const nt::ControlPoint2 cp2, const MakeTrace &make_trace)
+    {
+        const ScopedFlushDenormals flush_denormals;
+
+        std::fill(out, out + count, 0.f);
+        for(size_t a = 0; a < active_count; ++a)
+        {
+            auto      &voice = voices[active[a]];
+            const auto trace = make_trace(active[a]);
+            float      peak{0.f};
+            for(size_t i = 0; i < count; ++i)
+            {
+                const float sample = process_voice(voice, lfo_multiplier, cp1, cp2, trace).get();
+                out[i] += sample;
+                peak = std::max(peak, std::abs(sample));
+            }
+            slots[active[a]].level = peak;
+        }
+        sample_position += count;
+    }
+
+    size_t index_of(const Voice *voice) const noexcept
+    {
+        const auto first = reinterpret_cast<uintptr_t>(voices.data());
+        const auto value = reinterpret_cast<uintptr_t>(voice);
+        return (value >= first) ? (value - first) / sizeof(Voice) : MaxVoices;
+    }
+
+    //  Only reached when every voice is active, so the scan is over the full
+    //  pool but happens once per stolen note rather than per sample
+    uint16_t select_victim() const noexcept
+    {
+        uint16_t victim = active[0];
+        for(size_t a = 1; a < active_count; ++a)
+        {
+            if(steal_before(active[a], victim))
+            {
+                victim = active[a];
+            }
+        }
+        return victim;
+    }
+
+    bool steal_before(const uint16_t candidate, const uint16_t current) const noexcept
+    {
+        switch(steal_policy)
+        {
+        case STEAL_QUIETEST:
+            if(slots[candidate].level != slots[current].level)
+            {
+                return slots[candidate].level < slots[current].level;
+            }
+            break;
+        case STEAL_CLOSEST_TO_TARGET:
+        {
+            const float candidate_remaining = transit_remaining(voices[candidate]);
+            const float current_remaining   = transit_remaining(voices[current]);
+            if(candidate_remaining != current_remaining)
+            {
+                return candidate_remaining < current_remaining;
+            }
+            break;
+        }
+        case STEAL_OLDEST:
+        default:
+            break;
+        }
+        return slots[candidate].allocation_order < slots[current].allocation_order;
+    }
+
+    //  Fraction of the transit still to go, 0 at target
+    static float transit_remaining(const Voice &voice) noexcept
+    {
+        if(voice.is_at_target())
+        {
+            return 0.f;
+        }
+        const float target = voice.get_target_frequency().get();
+        const float span   = std::abs(target - voice.get_start_frequency().get());
+        const float to_go  = std::abs(target - voice.get_current_frequency().get());
+        return (span > 0.f) ? std::min(to_go / span, 1.f) : 0.f;
+    }
+
+    std::array<Voice, MaxVoices>    voices{};
+    std::array<Slot, MaxVoices>     slots{};
+    std::array<uint16_t, MaxVoices> active{};
+    size_t                          active_count{0};
+    uint16_t                        first_free{0};
+    uint64_t                        next_allocation_order{0};
+    uint64_t                        sample_position{0};
+    StealPolicy                     steal_policy{STEAL_OLDEST};
+};
+
+template <size_t MaxVoices, typename Voice> constexpr uint16_t VoicePool<MaxVoices, Voice>::NONE;
+
+} // namespace deepnote
@@ -0,0 +1,96 @@
+/**
+ * @file fixedbezier.hpp
+ * @brief Q31 cubic Bezier unit shaper for the fixed-point voice pipeline
+ *
+ * This file provides FixedBezierUnitShaper, the integer counterpart of
+ * BezierUnitShaper. All arithmetic is done in int64 on Q31 values.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "qmath.hpp"
+#include "util/namedtype.hpp"
+
+namespace deepnote
+{
+
+namespace nt
+{
+using FixedControlPoint1 = NamedType<int32_t, struct FixedControlPoint1Tag>;
+using FixedControlPoint2 = NamedType<int32_t, struct FixedControlPoint2Tag>;
+}; // namespace nt
+
+/**
+ * @brief Applies cubic Bezier curve shaping to Q31 unit input [0,1) -> [0,1)
+ *
+ * Same curve as BezierUnitShaper with fixed endpoints y1=0, y4=1:
+ * B(t) = 3(1-t)²*t*y2 + 3(1-t)*t²*y3 + t³
+ *
+ * Control points are Q31, so they are limited to [-1, 1); use float_to_q31()
+ * to convert from the float control points, which saturates 1.0 to the
+ * largest Q31 value. The output saturates to the Q31 range.
+ *
+ * @param y2 First control point, Q31
+ * @param y3 Second control point, Q31
+ */
+struct FixedBezierUnitShaper
+{
+    FixedBezierUnitShaper() = default;
+
+    explicit FixedBezierUnitShaper(const nt::FixedControlPoint1 y2, const nt::FixedControlPoint2 y3)
+        : y2(y2.get())
+        , y3(y3.get())
+    {
+    }
+
+    FixedBezierUnitShaper(const FixedBezierUnitShaper &other)            = default;
+    FixedBezierUnitShaper &operator=(const FixedBezierUnitShaper &other) = default;
+
+    /**
+     * @brief Apply Bezier curve transformation to input value
+     * @param t Input value in range [0,1), Q31
+     * @return Shaped output value, Q31
+     */
+    int32_t operator()(const int32_t t) const noexcept
+    {
+        const int64_t u  = constants::Q31_ONE - t;
+        const int64_t tt = q31_mul(t, t);
+        const int64_t uu = q31_mul(u, u);
+
+        const int64_t a = 3 * q31_mul(uu, t); //  3(1-t)²t, at most 4/9
+        const int64_t b = 3 * q31_mul(u, tt); //  3(1-t)t², at most 4/9
+        const int64_t c = q31_mul(tt, t);     //  t³
+
+        return saturate_to_int32(q31_mul(a, y2) + q31_mul(b, y3) + c);
+    }
+
+  private:
+    int64_t y2{0}; //  control point 1
+    int64_t y3{0}; //  control point 2
+};
+
+} // namespace deepnote
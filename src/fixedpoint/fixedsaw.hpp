@@ -0,0 +1,105 @@
+/**
+ * @file fixedsaw.hpp
+ * @brief Integer PolyBLEP sawtooth oscillator for the fixed-point voice pipeline
+ *
+ * This file provides FixedSawOscillator, the integer counterpart of
+ * SawOscillator running its PolyBLEP kernel. Phase is a uint32 that wraps
+ * naturally, so it never accumulates rounding drift however long it runs.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "oscillators/sawoscillator.hpp"
+#include "qmath.hpp"
+
+namespace deepnote
+{
+
+/**
+ * @brief Band-limited falling sawtooth on a uint32 phase accumulator
+ *
+ * A full cycle is 2^32 phase steps. The output is Q31 with amplitude
+ * constants::SAW_AMPLITUDE, matching SawOscillator with the POLYBLEP kernel.
+ * Phase increments above 2^31 are negative frequencies and run the phase
+ * backwards.
+ */
+struct FixedSawOscillator
+{
+    void reset(const uint32_t phase = 0) noexcept { this->phase = phase; }
+
+    void set_phase_inc(const uint32_t phase_inc) noexcept { this->phase_inc = phase_inc; }
+
+    uint32_t get_phase_inc() const noexcept { return phase_inc; }
+
+    uint32_t get_phase() const noexcept { return phase; }
+
+    /**
+     * @brief Generate the next sample
+     * @return Sample, Q31
+     */
+    int32_t process() noexcept
+    {
+        //  (1 - 2t) in Q31 needs one bit more than int32 at t = 0
+        int64_t out = constants::Q31_ONE - static_cast<int64_t>(phase);
+        out += polyblep();
+        phase += phase_inc;
+        return static_cast<int32_t>((out * AMPLITUDE) >> 31);
+    }
+
+  private:
+    static constexpr int64_t AMPLITUDE = static_cast<int64_t>(constants::SAW_AMPLITUDE * constants::Q31_ONE);
+
+    //  Same residual as SawOscillator::polyblep, with both sides of the
+    //  discontinuity measured as a distance in phase steps
+    int64_t polyblep() const noexcept
+    {
+        const uint32_t dt = (phase_inc > 0x80000000u) ? 0u - phase_inc : phase_inc;
+        if(dt == 0)
+        {
+            return 0;
+        }
+
+        if(phase < dt)
+        {
+            const int64_t d = constants::Q31_ONE - static_cast<int64_t>((static_cast<uint64_t>(phase) << 31) / dt);
+            return -q31_mul(d, d);
+        }
+
+        const uint32_t remaining = 0u - phase;
+        if(remaining < dt)
+        {
+            const int64_t d = constants::Q31_ONE - static_cast<int64_t>((static_cast<uint64_t>(remaining) << 31) / dt);
+            return q31_mul(d, d);
+        }
+        return 0;
+    }
+
+    uint32_t phase{0};
+    uint32_t phase_inc{0};
+};
+
+} // namespace deepnote
@@ -0,0 +1,75 @@
+/**
+ * @file fixedscaler.hpp
+ * @brief Q31 to Q16.16 scaler for the fixed-point voice pipeline
+ *
+ * This file provides FixedScaler, the integer counterpart of a Scaler with a
+ * unit input range, used to map shaped animation values onto frequencies.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "qmath.hpp"
+
+namespace deepnote
+{
+
+/**
+ * @brief Scales a Q31 unit value onto a Q16.16 output span
+ *
+ * Unlike Scaler the output span keeps its direction: 0 maps to start and 1
+ * maps to end whether end is above or below start, so descending transits
+ * don't need to flip the unit value first.
+ */
+struct FixedScaler
+{
+    FixedScaler() = default;
+
+    explicit FixedScaler(const int32_t start, const int32_t end)
+        : start(start)
+        , span(static_cast<int64_t>(end) - start)
+    {
+    }
+
+    FixedScaler(const FixedScaler &other)            = default;
+    FixedScaler &operator=(const FixedScaler &other) = default;
+
+    /**
+     * @brief Scale a unit value onto the output span
+     * @param value Unit value, Q31
+     * @return Scaled value, Q16.16
+     */
+    int32_t operator()(const int32_t value) const noexcept
+    {
+        return saturate_to_int32(start + q31_mul(span, value));
+    }
+
+  private:
+    int64_t start{0};
+    int64_t span{constants::Q16_ONE};
+};
+
+} // namespace deepnote
@@ -0,0 +1,470 @@
+/**
+ * @file fixedvoice.hpp
+ * @brief Fixed-point Deep Note voice for targets without a fast FPU
+ *
+ * This file provides BasicFixedDeepnoteVoice, an integer-only build of the
+ * voice pipeline, along with its init_voice() and process_voice() overloads.
+ * It renders the same sound as BasicDeepnoteVoice with the POLYBLEP kernel,
+ * within the rounding of its number formats, and produces bit-identical
+ * output on every platform.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "fixedbezier.hpp"
+#include "fixedsaw.hpp"
+#include "fixedscaler.hpp"
+#include "qmath.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace deepnote
+{
+namespace constants
+{
+static constexpr int32_t FIXED_TARGET_FREQUENCY_TOLERANCE =
+    static_cast<int32_t>(TARGET_FREQUENCY_TOLERANCE * Q16_ONE);
+//  Each oscillator contributes at most 1/16 of full scale, so a full 16
+//  oscillator voice can't overflow
+static constexpr int FIXED_OUTPUT_HEADROOM_BITS   = 4;
+static constexpr int FIXED_OUTPUT_FRACTIONAL_BITS = 31 - FIXED_OUTPUT_HEADROOM_BITS;
+} // namespace constants
+
+namespace nt
+{
+using FixedAnimationMultiplier = NamedType<int32_t, struct FixedAnimationMultiplierTag>; //  Q16.16
+using FixedOscillatorValue     = NamedType<int32_t, struct FixedOscillatorValueTag>;     //  Q4.27
+} // namespace nt
+
+/**
+ * @brief Convert fixed-point voice output to float
+ */
+inline float fixed_output_to_float(const nt::FixedOscillatorValue value) noexcept
+{
+    return static_cast<float>(value.get()) * (1.f / (int64_t(1) << constants::FIXED_OUTPUT_FRACTIONAL_BITS));
+}
+
+/**
+ * @brief An integer-only synthesizer voice implementing the THX Deep Note effect
+ *
+ * Number formats:
+ * - Frequencies are Q16.16 Hz, so the voice is limited to [0, 32768) Hz
+ * - The animation LFO and oscillators run on uint32 wraparound phase
+ * - LFO position and Bezier shaping are Q31
+ * - Output is Q4.27, see fixed_output_to_float()
+ *
+ * Setters and getters that take nt::OscillatorFrequency convert at control
+ * rate; nothing on the per-sample path touches floating point. Oscillators
+ * always use the PolyBLEP kernel.
+ *
+ * Usage matches BasicDeepnoteVoice, with the per-sample parameters of
+ * process_voice() given in fixed point.
+ *
+ * @tparam MaxOscillators Oscillator capacity of the voice, at most 16
+ */
+template <size_t MaxOscillators> struct BasicFixedDeepnoteVoice : DeepnoteVoiceBase
+{
+    static_assert(MaxOscillators > 0, "A voice needs at least one oscillator");
+    static_assert(MaxOscillators <= (size_t(1) << constants::FIXED_OUTPUT_HEADROOM_BITS),
+                  "Fixed-point output has headroom for at most 16 oscillators");
+
+    static constexpr size_t MAX_OSCILLATORS = MaxOscillators;
+
+    nt::OscillatorFrequency get_target_frequency() const noexcept
+    {
+        return nt::OscillatorFrequency(q16_to_float(target_frequency));
+    }
+
+    int32_t get_target_frequency_q16() const noexcept { return target_frequency; }
+
+    void set_target_frequency(const nt::OscillatorFrequency freq)
+    {
+        if(freq.get() < 0.0f)
+        {
+            throw std::invalid_argument("Target frequency must be non-negative");
+        }
+
+        //  set up a new transit from something close to the current frequency of
+        //  the voice and the new target frequency
+        this->start_frequency  = this->current_frequency;
+        this->target_frequency = float_to_q16(freq.get());
+        this->state            = PENDING_TRANSIT_TO_TARGET;
+    }
+
+    nt::OscillatorFrequency get_start_frequency() const noexcept
+    {
+        return nt::OscillatorFrequency(q16_to_float(start_frequency));
+    }
+
+    int32_t get_start_frequency_q16() const noexcept { return start_frequency; }
+
+    void set_start_frequency(const nt::OscillatorFrequency freq)
+    {
+        if(freq.get() < 0.0f)
+        {
+            throw std::invalid_argument("Start frequency must be non-negative");
+        }
+
+        //  set up a new transit from a new start frequency
+        this->start_frequency   = float_to_q16(freq.get());
+        this->current_frequency = this->start_frequency;
+        this->state             = PENDING_TRANSIT_TO_TARGET;
+    }
+
+    nt::OscillatorFrequency get_current_frequency() const noexcept
+    {
+        return nt::OscillatorFrequency(q16_to_float(current_frequency));
+    }
+
+    int32_t get_current_frequency_q16() const noexcept { return current_frequency; }
+
+    void set_current_frequency_q16(const int32_t freq) noexcept { this->current_frequency = freq; }
+
+    void scale_lfo_base_freq(const nt::FixedAnimationMultiplier multiplier)
+    {
+        if(multiplier.get() < 0)
+        {
+            throw std::invalid_argument("Animation multiplier must be non-negative");
+        }
+
+        const int64_t freq = (static_cast<int64_t>(lfo_base_freq) * multiplier.get()) >> 16;
+        lfo_phase_inc      = phase_inc_from_q16(saturate_to_int32(freq), phase_inc_per_hz_scaled);
+    }
+
+    bool is_at_target() const noexcept { return state == AT_TARGET; }
+
+    State get_state() const noexcept { return state; }
+
+    void set_state(const State state) noexcept { this->state = state; }
+
+    void init_lfo(const nt::SampleRate sample_rate, const nt::OscillatorFrequency base_freq)
+    {
+        if(sample_rate.get() <= 0.0f)
+        {
+            throw std::invalid_argument("Sample rate must be positive");
+        }
+        if(base_freq.get() < 0.0f)
+        {
+            throw std::invalid_argument("LFO base frequency must be non-negative");
+        }
+
+        phase_inc_per_hz_scaled = phase_inc_per_hz(sample_rate.get());
+        lfo_base_freq           = float_to_q16(base_freq.get());
+        lfo_phase_inc           = phase_inc_from_q16(lfo_base_freq, phase_inc_per_hz_scaled);
+        lfo_phase               = 0;
+    }
+
+    /**
+     * @brief Advance the animation LFO
+     * @return Ramp position [0,1), Q31
+     */
+    int32_t process_lfo() noexcept
+    {
+        const auto value = static_cast<int32_t>(lfo_phase >> 1);
+        lfo_phase += lfo_phase_inc;
+        return value;
+    }
+
+    void reset_lfo() noexcept { lfo_phase = 0; }
+
+    void init_oscillators(const size_t count, nt::SampleRate sample_rate, nt::OscillatorFrequency start_frequency)
+    {
+        if(count == 0)
+        {
+            throw std::invalid_argument("Oscillator count must be at least 1");
+        }
+        if(count > MAX_OSCILLATORS)
+        {
+            throw std::invalid_argument("Oscillator count exceeds maximum of " + std::to_string(MAX_OSCILLATORS));
+        }
+        if(sample_rate.get() <= 0.0f)
+        {
+            throw std::invalid_argument("Sample rate must be positive");
+        }
+        if(start_frequency.get() < 0.0f)
+        {
+            throw std::invalid_argument("Start frequency must be non-negative");
+        }
+
+        phase_inc_per_hz_scaled = phase_inc_per_hz(sample_rate.get());
+        oscillator_count        = count;
+        for(size_t i = 0; i < oscillator_count; ++i)
+        {
+            oscillators[i].oscillator.reset();
+            oscillators[i].oscillator.set_phase_inc(
+                phase_inc_from_q16(float_to_q16(start_frequency.get()), phase_inc_per_hz_scaled));
+            oscillators[i].detune_amount = 0;
+        }
+    }
+
+    /**
+     * @brief Detune oscillators symmetrically around the fundamental frequency
+     *
+     * Same distribution as BasicDeepnoteVoice::detune_oscillators().
+     *
+     * @param detune Detuning amount in Hz for each step
+     */
+    void detune_oscillators(const nt::DetuneHz detune)
+    {
+        const auto    half = oscillator_count / 2;
+        const int32_t step = float_to_q16(detune.get());
+        for(size_t i = 0; i < oscillator_count; ++i)
+        {
+            if(oscillator_count <= 1)
+            {
+                oscillators[i].detune_amount = 0;
+            }
+            else
+            {
+                const int8_t idx             = i - half + ((i >= half) ? 1 : 0);
+                oscillators[i].detune_amount = idx * step;
+            }
+        }
+    }
+
+    /**
+     * @brief Detune oscillators by random amounts
+     *
+     * Same draws as BasicDeepnoteVoice::detune_oscillators(detune, random),
+     * so float and fixed-point voices given equal streams detune alike.
+     *
+     * @param detune Detuning amount in Hz for each step
+     * @param random Stream to draw from, typically keyed by voice index
+     */
+    void detune_oscillators(const nt::DetuneHz detune, RandomStream &random)
+    {
+        const float span = static_cast<float>(oscillator_count / 2) * detune.get();
+        for(size_t i = 0; i < oscillator_count; ++i)
+        {
+            oscillators[i].detune_amount = float_to_q16(random.next_uniform(-span, span));
+        }
+    }
+
+    size_t get_oscillator_count() const noexcept { return oscillator_count; }
+
+    nt::FixedOscillatorValue process_oscillators() noexcept
+    {
+        int32_t osc_value{0};
+        for(size_t i = 0; i < oscillator_count; ++i)
+        {
+            auto         &oscillator = oscillators[i].oscillator;
+            const int32_t frequency  = saturate_to_int32(static_cast<int64_t>(current_frequency) +
+                                                        oscillators[i].detune_amount);
+            oscillator.set_phase_inc(phase_inc_from_q16(frequency, phase_inc_per_hz_scaled));
+            osc_value += oscillator.process() >> constants::FIXED_OUTPUT_HEADROOM_BITS;
+        }
+        return nt::FixedOscillatorValue(osc_value);
+    }
+
+  private:
+    struct DetunedOscillator
+    {
+        FixedSawOscillator oscillator;
+        int32_t            detune_amount;
+    };
+
+    State                                          state{PENDING_TRANSIT_TO_TARGET};
+    int32_t                                        start_frequency{0};
+    int32_t                                        target_frequency{0};
+    int32_t                                        current_frequency{0};
+    std::array<DetunedOscillator, MAX_OSCILLATORS> oscillators{};
+    size_t                                         oscillator_count{0};
+    int64_t                                        phase_inc_per_hz_scaled{0};
+    int32_t                                        lfo_base_freq{0};
+    uint32_t                                       lfo_phase{0};
+    uint32_t                                       lfo_phase_inc{0};
+};
+
+template <size_t MaxOscillators> constexpr size_t BasicFixedDeepnoteVoice<MaxOscillators>::MAX_OSCILLATORS;
+
+using FixedDeepnoteVoice = BasicFixedDeepnoteVoice<constants::DEFAULT_MAX_OSCILLATORS>;
+
+/**
+ * @brief Initialize a FixedDeepnoteVoice with specified parameters
+ *
+ * @param voice Voice instance to initialize
+ * @param oscillator_count Number of oscillators (1 to MAX_OSCILLATORS)
+ * @param start_frequency Initial frequency in Hz
+ * @param sample_rate Audio sample rate in Hz
+ * @param lfo_frequency Base LFO frequency for animation in Hz
+ * @param detune Oscillator detuning amount in Hz (default: 2.5 Hz)
+ */
+template <size_t MaxOscillators>
+void init_voice(BasicFixedDeepnoteVoice<MaxOscillators> &voice, const size_t oscillator_count,
+                const nt::OscillatorFrequency start_frequency, const nt::SampleRate sample_rate,
+                const nt::OscillatorFrequency lfo_frequency,
+                const nt::DetuneHz            detune = nt::DetuneHz(constants::DEFAULT_DETUNE_HZ))
+{
+    voice.set_start_frequency(start_frequency);
+    voice.set_target_frequency(start_frequency);
+    voice.set_state(voice.PENDING_TRANSIT_TO_TARGET);
+    voice.init_lfo(sample_rate, lfo_frequency);
+    voice.init_oscillators(oscillator_count, sample_rate, start_frequency);
+    voice.detune_oscillators(detune);
+}
+
+/**
+ * @brief Initialize a FixedDeepnoteVoice at a random start frequency with random detuning
+ *
+ * Same draws as the DeepnoteVoice overload.
+ *
+ * @param voice Voice instance to initialize
+ * @param oscillator_count Number of oscillators (1 to MAX_OSCILLATORS)
+ * @param start_range Range to draw the initial frequency from, in Hz
+ * @param sample_rate Audio sample rate in Hz
+ * @param lfo_frequency Base LFO frequency for animation in Hz
+ * @param detune Oscillator detuning amount in Hz for each step
+ * @param random Stream to draw from, typically keyed by voice index
+ */
+template <size_t MaxOscillators>
+void init_voice(BasicFixedDeepnoteVoice<MaxOscillators> &voice, const size_t oscillator_count,
+                const Range &start_range, const nt::SampleRate sample_rate, const nt::OscillatorFrequency lfo_frequency,
+                const nt::DetuneHz detune, RandomStream &random)
+{
+    const nt::OscillatorFrequency start_frequency(
+        random.next_uniform(start_range.get_low().get(), start_range.get_high().get()));
+    init_voice(voice, oscillator_count, start_frequency, sample_rate, lfo_frequency, detune);
+    voice.detune_oscillators(detune, random);
+}
+
+namespace
+{
+template <size_t MaxOscillators>
+int32_t calculate_shaped_frequency(BasicFixedDeepnoteVoice<MaxOscillators> &voice,
+                                   const nt::FixedAnimationMultiplier lfo_multiplier, const nt::FixedControlPoint1 cp1,
+                                   const nt::FixedControlPoint2 cp2)
+{
+    voice.scale_lfo_base_freq(lfo_multiplier);
+    const int32_t raw_lfo_value    = voice.process_lfo();
+    const int32_t shaped_lfo_value = FixedBezierUnitShaper(cp1, cp2)(raw_lfo_value);
+
+    //  FixedScaler keeps direction, so descending transits need no flip
+    return FixedScaler(voice.get_start_frequency_q16(), voice.get_target_frequency_q16())(shaped_lfo_value);
+}
+
+template <size_t MaxOscillators>
+DeepnoteVoiceBase::State update_voice_state(const BasicFixedDeepnoteVoice<MaxOscillators> &voice,
+                                            const DeepnoteVoiceBase::State                  current_state,
+                                            const int32_t                                   current_frequency)
+{
+    auto          state            = current_state;
+    const int32_t target_frequency = voice.get_target_frequency_q16();
+    const int32_t freq_low         = std::min(voice.get_start_frequency_q16(), target_frequency);
+    const int32_t freq_high        = std::max(voice.get_start_frequency_q16(), target_frequency);
+
+    if(current_frequency >= freq_low && current_frequency <= freq_high)
+    {
+        if(state == DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET &&
+           std::abs(static_cast<int64_t>(current_frequency) - target_frequency) <=
+               constants::FIXED_TARGET_FREQUENCY_TOLERANCE)
+        {
+            state = DeepnoteVoiceBase::AT_TARGET;
+        }
+    }
+    else
+    {
+        state = (state == DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET) ? DeepnoteVoiceBase::AT_TARGET : state;
+    }
+
+    return state;
+}
+
+template <size_t MaxOscillators>
+int32_t constrain_frequency(const BasicFixedDeepnoteVoice<MaxOscillators> &voice, const int32_t frequency)
+{
+    const int32_t freq_low  = std::min(voice.get_start_frequency_q16(), voice.get_target_frequency_q16());
+    const int32_t freq_high = std::max(voice.get_start_frequency_q16(), voice.get_target_frequency_q16());
+    return std::min(std::max(frequency, freq_low), freq_high);
+}
+} // namespace
+
+/**
+ * @brief Process a single audio sample from a fixed-point voice
+ *
+ * Integer counterpart of process_voice() for BasicDeepnoteVoice. The trace
+ * functor receives frequencies in Q16.16 and the output in Q4.27.
+ *
+ * @param voice Voice instance to process
+ * @param lfo_multiplier Speed multiplier for animation, Q16.16 (65536 = normal speed)
+ * @param cp1 First Bezier control point, Q31
+ * @param cp2 Second Bezier control point, Q31
+ * @param trace_functor Optional function for debugging/logging (default: no-op)
+ * @return Combined oscillator output value, Q4.27
+ */
+template <size_t MaxOscillators, typename TraceFunc = NoopTrace>
+nt::FixedOscillatorValue process_voice(BasicFixedDeepnoteVoice<MaxOscillators> &voice,
+                                       const nt::FixedAnimationMultiplier lfo_multiplier,
+                                       const nt::FixedControlPoint1 cp1, const nt::FixedControlPoint2 cp2,
+                                       const TraceFunc &trace_functor = NoopTrace())
+{
+    int32_t    unconstrained_freq{0}; // only used for tracing
+    const auto in_state{voice.get_state()};
+    auto       state = in_state;
+
+    if(state == DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET)
+    {
+        voice.reset_lfo();
+        state = DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET;
+    }
+
+    const int32_t start_frequency  = voice.get_start_frequency_q16();
+    const int32_t target_frequency = voice.get_target_frequency_q16();
+    int32_t       current_frequency{0};
+
+    if(state == DeepnoteVoiceBase::AT_TARGET)
+    {
+        current_frequency = target_frequency;
+    }
+    else
+    {
+        current_frequency  = calculate_shaped_frequency(voice, lfo_multiplier, cp1, cp2);
+        unconstrained_freq = current_frequency;
+        state              = update_voice_state(voice, state, current_frequency);
+        current_frequency  = constrain_frequency(voice, current_frequency);
+
+        if(state == DeepnoteVoiceBase::AT_TARGET)
+        {
+            current_frequency = target_frequency;
+        }
+    }
+
+    voice.set_current_frequency_q16(current_frequency);
+    voice.set_state(state);
+
+    const auto osc_value = voice.process_oscillators();
+
+    trace_functor(start_frequency, target_frequency, in_state, state, 0, 0, unconstrained_freq, current_frequency,
+                  osc_value.get());
+
+    return osc_value;
+}
+
+} // namespace deepnote
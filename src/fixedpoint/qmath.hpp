@@ -0,0 +1,120 @@
+/**
+ * @file qmath.hpp
+ * @brief Fixed-point number formats for the Deep Note synthesizer
+ *
+ * This file provides the Q formats and conversions used by the fixed-point
+ * voice pipeline: Q31 for unit values such as LFO position and Bezier output,
+ * Q16.16 for frequencies in Hz, and uint32 wraparound phase for oscillators.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace deepnote
+{
+namespace constants
+{
+static constexpr int64_t Q31_ONE = int64_t(1) << 31;
+static constexpr int64_t Q16_ONE = int64_t(1) << 16;
+} // namespace constants
+
+/**
+ * @brief Convert a float to Q31, saturating to [-1, 1)
+ */
+constexpr int32_t float_to_q31(const float value) noexcept
+{
+    return (value >= 1.f)    ? INT32_MAX
+           : (value <= -1.f) ? INT32_MIN
+                             : static_cast<int32_t>(static_cast<double>(value) * constants::Q31_ONE);
+}
+
+constexpr float q31_to_float(const int32_t value) noexcept
+{
+    return static_cast<float>(static_cast<double>(value) / constants::Q31_ONE);
+}
+
+/**
+ * @brief Convert a float to Q16.16, saturating to [-32768, 32768)
+ */
+constexpr int32_t float_to_q16(const float value) noexcept
+{
+    return (value >= 32768.f)   ? INT32_MAX
+           : (value <= -32768.f) ? INT32_MIN
+                                 : static_cast<int32_t>(static_cast<double>(value) * constants::Q16_ONE +
+                                                        (value < 0.f ? -0.5 : 0.5));
+}
+
+constexpr float q16_to_float(const int32_t value) noexcept
+{
+    return static_cast<float>(static_cast<double>(value) / constants::Q16_ONE);
+}
+
+/**
+ * @brief Multiply two Q31 values, widening to avoid overflow
+ */
+constexpr int64_t q31_mul(const int64_t a, const int64_t b) noexcept
+{
+    return (a * b) >> 31;
+}
+
+/**
+ * @brief Saturate a widened value back to int32
+ */
+constexpr int32_t saturate_to_int32(const int64_t value) noexcept
+{
+    return (value > INT32_MAX) ? INT32_MAX : (value < INT32_MIN) ? INT32_MIN : static_cast<int32_t>(value);
+}
+
+/**
+ * @brief Phase increment per Hz for uint32 wraparound phase
+ *
+ * The increment is scaled by 2^8, which keeps products with any Q16.16
+ * frequency inside int64 for sample rates of 1kHz and above while resolving
+ * increments to better than 1 part in 10^7.
+ *
+ * @param sample_rate Audio sample rate in Hz
+ */
+inline int64_t phase_inc_per_hz(const float sample_rate) noexcept
+{
+    return static_cast<int64_t>(4294967296.0 / sample_rate * 16777216.0 / constants::Q16_ONE + 0.5);
+}
+
+/**
+ * @brief Convert a Q16.16 frequency to a uint32 phase increment
+ *
+ * Negative frequencies wrap to increments that run the phase backwards.
+ *
+ * @param frequency Frequency in Hz, Q16.16
+ * @param inc_per_hz Result of phase_inc_per_hz() for the sample rate
+ */
+inline uint32_t phase_inc_from_q16(const int32_t frequency, const int64_t inc_per_hz) noexcept
+{
+    return static_cast<uint32_t>((static_cast<int64_t>(frequency) * inc_per_hz) >> 24);
+}
+
+} // namespace deepnote
@@ -0,0 +1,271 @@
+/**
+ * @file sawoscillator.hpp
+ * @brief Anti-aliased sawtooth oscillator for the Deep Note synthesizer
+ *
+ * This file provides the SawOscillator used by each voice oscillator. The
+ * oscillator can render its sawtooth with one of several anti-aliasing kernels
+ * of increasing cost and quality, and offers a helper to choose the cheapest
+ * kernel that stays alias-free for a given frequency.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace deepnote
+{
+namespace constants
+{
+//  Amplitude of the sawtooth, matches the default amplitude of daisysp::Oscillator
+static constexpr float SAW_AMPLITUDE = 0.5f;
+//  Below this phase increment (frequency / sample rate) the first aliased partial
+//  of a naive sawtooth is at least 48dB below the fundamental
+static constexpr float NAIVE_SAW_MAX_PHASE_INC = 1.f / 512.f;
+//  Above this phase increment a 2-point PolyBLEP leaves audible aliasing
+static constexpr float POLYBLEP_SAW_MAX_PHASE_INC = 1.f / 8.f;
+} // namespace constants
+
+/**
+ * @brief Falling sawtooth oscillator with selectable anti-aliasing kernel
+ *
+ * The waveform, phase convention and amplitude match daisysp::Oscillator's
+ * WAVE_POLYBLEP_SAW so the POLYBLEP kernel is a drop-in replacement for it.
+ *
+ * Kernels:
+ * - NAIVE: trivial sawtooth, no correction. Only alias-free at low frequencies.
+ * - POLYBLEP: 2-point polynomial band-limited step at each discontinuity.
+ * - POLYBLEP4: 4-point band-limited step derived from the cubic B-spline.
+ *   Suppresses aliasing much further at the cost of a slightly softer top end,
+ *   intended for frequencies approaching Nyquist.
+ */
+struct SawOscillator
+{
+    enum Kernel : uint8_t
+    {
+        NAIVE,
+        POLYBLEP,
+        POLYBLEP4
+    };
+
+    void init(const float sample_rate) noexcept
+    {
+        sr_recip  = 1.f / sample_rate;
+        phase     = 0.f;
+        phase_inc = 0.f;
+        kernel    = POLYBLEP;
+    }
+
+    void set_freq(const float freq) noexcept { phase_inc = freq * sr_recip; }
+
+    /**
+     * @brief Set the increment directly, for callers that compute it themselves
+     * @param phase_inc Frequency divided by sample rate
+     */
+    void set_phase_inc(const float phase_inc) noexcept { this->phase_inc = phase_inc; }
+
+    float get_phase_inc() const noexcept { return phase_inc; }
+
+    void set_kernel(const Kernel kernel) noexcept { this->kernel = kernel; }
+
+    Kernel get_kernel() const noexcept { return kernel; }
+
+    void reset(const float phase = 0.f) noexcept { this->phase = phase; }
+
+    float process() noexcept { return step(phase, phase_inc, kernel); }
+
+    /**
+     * @brief Render from a band-limited table instead of a BLEP kernel
+     * @param table Any type providing read(phase, phase_inc), e.g. SawWavetable
+     * @return Table output at the current phase
+     */
+    template <typename Table> float process(const Table &table) noexcept { return step(table, phase, phase_inc); }
+
+    /**
+     * @brief One sample of a sawtooth held elsewhere, advancing its phase
+     *
+     * The arithmetic behind process(), for oscillator state that isn't kept
+     * in a SawOscillator, e.g. SawOscillatorBank.
+     */
+    static float step(float &phase, const float phase_inc, const Kernel kernel) noexcept
+    {
+        const float dt  = std::fabs(phase_inc);
+        float       out = 1.f - (2.f * phase);
+
+        switch(kernel)
+        {
+        case POLYBLEP:
+            out += polyblep(phase, dt);
+            break;
+        case POLYBLEP4:
+            out += polyblep4(phase, dt);
+            break;
+        case NAIVE:
+        default:
+            break;
+        }
+
+        advance(phase, phase_inc);
+        return out * constants::SAW_AMPLITUDE;
+    }
+
+    template <typename Table> static float step(const Table &table, float &phase, const float phase_inc) noexcept
+    {
+        const float out = table.read(phase, phase_inc);
+        advance(phase, phase_inc);
+        return out;
+    }
+
+    /**
+     * @brief Choose the cheapest kernel that is alias-free for a phase increment
+     * @param phase_inc Frequency divided by sample rate
+     * @return NAIVE at very low, POLYBLEP at mid and POLYBLEP4 at high frequencies
+     */
+    static Kernel select_kernel(const float phase_inc) noexcept
+    {
+        const float dt = std::fabs(phase_inc);
+        if(dt < constants::NAIVE_SAW_MAX_PHASE_INC)
+        {
+            return NAIVE;
+        }
+        return (dt < constants::POLYBLEP_SAW_MAX_PHASE_INC) ? POLYBLEP : POLYBLEP4;
+    }
+
+  private:
+    static void advance(float &phase, const float phase_inc) noexcept
+    {
+        phase += phase_inc;
+        if(phase > 1.f)
+        {
+            phase -= 1.f;
+        }
+        else if(phase < 0.f)
+        {
+            phase += 1.f;
+        }
+    }
+
+    //  2-point residual, twice the integrated linear B-spline minus the unit step
+    static float polyblep(float t, const float dt) noexcept
+    {
+        if(t < dt)
+        {
+            t /= dt;
+            return t + t - t * t - 1.f;
+        }
+        else if(t > 1.f - dt)
+        {
+            t = (t - 1.f) / dt;
+            return t * t + t + t + 1.f;
+        }
+        return 0.f;
+    }
+
+    //  4-point residual magnitude, twice the integrated cubic B-spline tail.
+    //  y is the distance from the discontinuity in samples, [0, 2).
+    static float bspline_tail(const float y) noexcept
+    {
+        if(y < 1.f)
+        {
+            const float y2 = y * y;
+            return (12.f - 16.f * y + 8.f * y2 * y - 3.f * y2 * y2) / 12.f;
+        }
+        const float a = 2.f - y;
+        return (a * a * a * a) / 12.f;
+    }
+
+    //  near Nyquist the kernel spans the discontinuities either side of a
+    //  sample, so both contributions are summed rather than chosen
+    static float polyblep4(const float t, const float dt) noexcept
+    {
+        float residual{0.f};
+        if(t < 2.f * dt)
+        {
+            residual -= bspline_tail(t / dt);
+        }
+        if(t > 1.f - 2.f * dt)
+        {
+            residual += bspline_tail((1.f - t) / dt);
+        }
+        return residual;
+    }
+
+    float  sr_recip{0.f};
+    float  phase{0.f};
+    float  phase_inc{0.f};
+    Kernel kernel{POLYBLEP};
+};
+
+/**
+ * @brief A bank of sawtooth oscillators sharing one sample rate
+ *
+ * Holds only what differs between oscillators, phase, increment and kernel,
+ * in separate arrays: 9 bytes an oscillator against 16 for a SawOscillator,
+ * whose sample period is the same in every oscillator of a voice, and
+ * increments that sit next to each other for vector loops. Output is
+ * identical to a SawOscillator with the same increment and kernel.
+ *
+ * @tparam Capacity Number of oscillators
+ */
+template <size_t Capacity> struct SawOscillatorBank
+{
+    using Kernel = SawOscillator::Kernel;
+
+    static constexpr size_t capacity() noexcept { return Capacity; }
+
+    void set_phase_inc(const size_t index, const float phase_inc) noexcept { phase_incs[index] = phase_inc; }
+
+    float get_phase_inc(const size_t index) const noexcept { return phase_incs[index]; }
+
+    void set_kernel(const size_t index, const Kernel kernel) noexcept { kernels[index] = kernel; }
+
+    Kernel get_kernel(const size_t index) const noexcept { return kernels[index]; }
+
+    void reset(const size_t index, const float phase = 0.f) noexcept
+    {
+        phases[index]  = phase;
+        kernels[index] = SawOscillator::POLYBLEP;
+    }
+
+    float process(const size_t index) noexcept
+    {
+        return SawOscillator::step(phases[index], phase_incs[index], kernels[index]);
+    }
+
+    template <typename Table> float process(const size_t index, const Table &table) noexcept
+    {
+        return SawOscillator::step(table, phases[index], phase_incs[index]);
+    }
+
+  private:
+    std::array<float, Capacity>  phases{};
+    std::array<float, Capacity>  phase_incs{};
+    std::array<Kernel, Capacity> kernels{};
+};
+
+} // namespace deepnote
@@ -0,0 +1,165 @@
+/**
+ * @file wavetable.hpp
+ * @brief Mipmapped band-limited sawtooth wavetable for the Deep Note synthesizer
+ *
+ * This file provides the SawWavetable class, a set of band-limited sawtooth
+ * tables with one level per octave. The tables are built once and are
+ * read-only afterwards so a single instance can be shared by every voice.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "sawoscillator.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace deepnote
+{
+namespace constants
+{
+static constexpr size_t SAW_WAVETABLE_SIZE   = 2048;
+static constexpr size_t SAW_WAVETABLE_LEVELS = 11;
+} // namespace constants
+
+/**
+ * @brief Band-limited sawtooth tables, one mip level per octave
+ *
+ * Level 0 holds SAW_WAVETABLE_SIZE / 2 harmonics and each following level holds
+ * half as many, down to a single sine at the last level. A level is only read
+ * while its highest harmonic is below Nyquist, so playback is alias-free.
+ * Between levels the output is crossfaded towards the next (duller) level as
+ * frequency rises, which keeps sweeps free of timbre steps.
+ *
+ * The waveform matches SawOscillator: a falling sawtooth with amplitude
+ * constants::SAW_AMPLITUDE.
+ */
+struct SawWavetable
+{
+    SawWavetable()
+    {
+        //  offline additive synthesis, the sine table makes every partial exact
+        const double             two_pi = 6.283185307179586;
+        std::array<double, SIZE> sine{};
+        for(size_t n = 0; n < SIZE; ++n)
+        {
+            sine[n] = std::sin(two_pi * n / SIZE);
+        }
+
+        const double gain = constants::SAW_AMPLITUDE * 2.0 / 3.141592653589793;
+        for(size_t level = 0; level < constants::SAW_WAVETABLE_LEVELS; ++level)
+        {
+            const size_t harmonics = (SIZE / 2) >> level;
+            for(size_t n = 0; n < SIZE; ++n)
+            {
+                double value{0.0};
+                for(size_t k = 1; k <= harmonics; ++k)
+                {
+                    value += sine[(k * n) % SIZE] / k;
+                }
+                levels[level][n] = static_cast<float>(value * gain);
+            }
+
+            //  guard points so interpolation never has to wrap
+            levels[level][SIZE]     = levels[level][0];
+            levels[level][SIZE + 1] = levels[level][1];
+        }
+    }
+
+    SawWavetable(const SawWavetable &other)            = delete;
+    SawWavetable &operator=(const SawWavetable &other) = delete;
+
+    /**
+     * @brief Tables shared by all voices, built on first use
+     */
+    static const SawWavetable &shared()
+    {
+        static const SawWavetable table;
+        return table;
+    }
+
+    /**
+     * @brief Read the band-limited sawtooth
+     * @param phase Oscillator phase [0,1]
+     * @param phase_inc Frequency divided by sample rate, selects the mip levels
+     * @return Interpolated sample crossfaded between the two nearest levels
+     */
+    float read(const float phase, const float phase_inc) const noexcept
+    {
+        size_t level{0};
+        float  blend{0.f};
+        mip_position(phase_inc, level, blend);
+
+        const float  position = phase * SIZE;
+        const size_t index    = std::min(static_cast<size_t>(position), constants::SAW_WAVETABLE_SIZE);
+        const float  frac     = position - index;
+
+        const float lower = lerp(levels[level][index], levels[level][index + 1], frac);
+        if(blend == 0.f)
+        {
+            return lower;
+        }
+        const float upper = lerp(levels[level + 1][index], levels[level + 1][index + 1], frac);
+        return lerp(lower, upper, blend);
+    }
+
+  private:
+    static constexpr size_t SIZE = constants::SAW_WAVETABLE_SIZE;
+
+    static float lerp(const float a, const float b, const float t) noexcept { return a + (b - a) * t; }
+
+    //  Octave position of the increment relative to the point where level 0's
+    //  highest harmonic reaches a quarter of the sample rate. The exponent gives
+    //  the level exactly, the mantissa is used as a linear crossfade weight.
+    static void mip_position(const float phase_inc, size_t &level, float &blend) noexcept
+    {
+        const float octaves = std::fabs(phase_inc) * (2.f * SIZE);
+        if(!(octaves >= 1.f))
+        {
+            level = 0;
+            blend = 0.f;
+            return;
+        }
+
+        uint32_t bits;
+        std::memcpy(&bits, &octaves, sizeof(bits));
+        level = static_cast<size_t>((bits >> 23) & 0xff) - 127;
+        blend = static_cast<float>(bits & 0x7fffff) * (1.f / 8388608.f);
+
+        if(level >= constants::SAW_WAVETABLE_LEVELS - 1)
+        {
+            level = constants::SAW_WAVETABLE_LEVELS - 1;
+            blend = 0.f;
+        }
+    }
+
+    std::array<std::array<float, SIZE + 2>, constants::SAW_WAVETABLE_LEVELS> levels{};
+};
+
+} // namespace deepnote
@@ -0,0 +1,241 @@
+/**
+ * @file mapping.hpp
+ * @brief Fused parameter mappings for the Deep Note synthesizer
+ *
+ * This file provides a small compile-time DSL that composes scalers, unit
+ * shapers and clamps into a single functor. Polynomial stages are folded
+ * together as they are composed, so a chain such as
+ * Scaler -> BezierUnitShaper -> Scaler costs one cubic evaluation per value.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "range.hpp"
+#include "scaler.hpp"
+#include "unitshapers/bezier.hpp"
+#include "unitshapers/linear.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+namespace deepnote
+{
+
+/**
+ * @brief Base of every mapping stage, provides buffer processing
+ *
+ * Stages are composed left to right with operator|, i.e. (f | g)(x) is
+ * g(f(x)).
+ */
+template <typename Derived> struct Mapping
+{
+    /**
+     * @brief Map a buffer, in and out may alias
+     */
+    void process(const float *in, float *out, const size_t count) const noexcept
+    {
+        const auto &mapping = static_cast<const Derived &>(*this);
+        for(size_t i = 0; i < count; ++i)
+        {
+            out[i] = mapping(in[i]);
+        }
+    }
+};
+
+template <typename T> struct is_mapping : std::is_base_of<Mapping<T>, T>
+{
+};
+
+/**
+ * @brief y = slope * x + offset
+ */
+struct Affine : Mapping<Affine>
+{
+    constexpr Affine(const float slope, const float offset)
+        : slope(slope)
+        , offset(offset)
+    {
+    }
+
+    constexpr float operator()(const float x) const noexcept { return slope * x + offset; }
+
+    float slope;
+    float offset;
+};
+
+/**
+ * @brief y = c0 + c1 * x + c2 * x² + c3 * x³, evaluated with Horner's scheme
+ */
+struct Cubic : Mapping<Cubic>
+{
+    constexpr Cubic(const float c0, const float c1, const float c2, const float c3)
+        : c0(c0)
+        , c1(c1)
+        , c2(c2)
+        , c3(c3)
+    {
+    }
+
+    constexpr float operator()(const float x) const noexcept { return ((c3 * x + c2) * x + c1) * x + c0; }
+
+    float c0;
+    float c1;
+    float c2;
+    float c3;
+};
+
+/**
+ * @brief Clamp to [low, high], branchless
+ */
+struct Clamp : Mapping<Clamp>
+{
+    constexpr Clamp(const float low, const float high)
+        : low(low < high ? low : high)
+        , high(high > low ? high : low)
+    {
+    }
+
+    constexpr float operator()(const float x) const noexcept
+    {
+        return std::min(std::max(x, low), high);
+    }
+
+    float low;
+    float high;
+};
+
+/**
+ * @brief Two stages that don't fold into one, evaluated in order
+ */
+template <typename First, typename Second> struct Chain : Mapping<Chain<First, Second>>
+{
+    constexpr Chain(const First &first, const Second &second)
+        : first(first)
+        , second(second)
+    {
+    }
+
+    constexpr float operator()(const float x) const noexcept { return second(first(x)); }
+
+    First  first;
+    Second second;
+};
+
+//
+//  Stage factories. The float overloads are constexpr so constant mappings
+//  fold at compile time; the others adapt the existing runtime types.
+//
+
+/**
+ * @brief Linear map from [in_low, in_high] to [out_low, out_high]
+ *
+ * Unlike Scaler the output keeps its direction, out_low may be above out_high.
+ */
+constexpr Affine scale(const float in_low, const float in_high, const float out_low, const float out_high)
+{
+    return Affine((out_high - out_low) / (in_high - in_low),
+                  out_low - in_low * (out_high - out_low) / (in_high - in_low));
+}
+
+inline Affine scale(const Scaler &scaler)
+{
+    return scale(scaler.get_input().get_low().get(), scaler.get_input().get_high().get(),
+                 scaler.get_output().get_low().get(), scaler.get_output().get_high().get());
+}
+
+/**
+ * @brief The cubic of a BezierUnitShaper with control points y2 and y3
+ */
+constexpr Cubic bezier(const float y2, const float y3)
+{
+    return Cubic(0.f, 3.f * y2, 3.f * y3 - 6.f * y2, 3.f * y2 - 3.f * y3 + 1.f);
+}
+
+inline Cubic shape(const BezierUnitShaper &shaper)
+{
+    return bezier(shaper.get_control_point1().get(), shaper.get_control_point2().get());
+}
+
+constexpr Affine shape(const LinearUnitShaper &)
+{
+    return Affine(1.f, 0.f);
+}
+
+constexpr Clamp clamp(const float low, const float high)
+{
+    return Clamp(low, high);
+}
+
+inline Clamp clamp(const Range &range)
+{
+    return Clamp(range.get_low().get(), range.get_high().get());
+}
+
+//
+//  Composition. Polynomials of total degree three or less fold into a single
+//  stage; anything else becomes a Chain.
+//
+
+template <typename First, typename Second,
+          typename = typename std::enable_if<is_mapping<First>::value && is_mapping<Second>::value>::type>
+constexpr Chain<First, Second> operator|(const First &first, const Second &second)
+{
+    return Chain<First, Second>(first, second);
+}
+
+constexpr Affine operator|(const Affine &first, const Affine &second)
+{
+    return Affine(second.slope * first.slope, second.slope * first.offset + second.offset);
+}
+
+constexpr Cubic operator|(const Cubic &first, const Affine &second)
+{
+    return Cubic(second.slope * first.c0 + second.offset, second.slope * first.c1, second.slope * first.c2,
+                 second.slope * first.c3);
+}
+
+constexpr Cubic operator|(const Affine &first, const Cubic &second)
+{
+    //  substitute x = a * t + b into the cubic and collect powers of t
+    const float a = first.slope;
+    const float b = first.offset;
+    return Cubic(second.c0 + b * (second.c1 + b * (second.c2 + b * second.c3)),
+                 a * (second.c1 + b * (2.f * second.c2 + 3.f * b * second.c3)),
+                 a * a * (second.c2 + 3.f * b * second.c3), a * a * a * second.c3);
+}
+
+//  Keep folding into the tail of a chain so (clamp | cubic | affine) still
+//  evaluates as one clamp and one cubic
+template <typename First, typename Second, typename Next,
+          typename = typename std::enable_if<is_mapping<Next>::value>::type>
+constexpr auto operator|(const Chain<First, Second> &chain, const Next &next)
+    -> Chain<First, decltype(chain.second | next)>
+{
+    return Chain<First, decltype(chain.second | next)>(chain.first, chain.second | next);
+}
+
+} // namespace deepnote
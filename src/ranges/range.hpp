@@ -34,6 +34,14 @@
 #pragma once
 
 #include "util/namedtype.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DEEPNOTE_RANGE_SSE
+#endif
 
 namespace deepnote
 {
@@ -91,6 +99,70 @@ struct Range
         return value;
     }
 
+    //
+    //  Buffer versions of contains() and constrain() for per-sample control
+    //  buffers. The loops are branchless so the compiler can vectorize them,
+    //  and they give the same results as the scalar versions.
+    //  contains() uses SSE directly where available.
+    //
+
+    /**
+     * @brief Number of mask words contains() writes for count values
+     */
+    static constexpr size_t mask_words(const size_t count) noexcept { return (count + 31) / 32; }
+
+    /**
+     * @brief Test a buffer of values against the range
+     * @param values Values to test
+     * @param mask Receives mask_words(count) words, bit (i % 32) of word (i / 32) set if values[i] is in range
+     * @param count Number of values
+     */
+    void contains(const float *values, uint32_t *mask, const size_t count) const noexcept
+    {
+        const float lo = low.get();
+        const float hi = high.get();
+#if defined(DEEPNOTE_RANGE_SSE)
+        //  packing comparisons into bits doesn't auto-vectorize, but SSE has
+        //  an instruction for exactly that
+        const __m128 lo4 = _mm_set1_ps(lo);
+        const __m128 hi4 = _mm_set1_ps(hi);
+#endif
+        for(size_t word = 0; word < mask_words(count); ++word)
+        {
+            const size_t first = word * 32;
+            const size_t last  = std::min(first + 32, count);
+            uint32_t     bits{0};
+            size_t       i = first;
+#if defined(DEEPNOTE_RANGE_SSE)
+            for(; i + 4 <= last; i += 4)
+            {
+                const __m128 value4 = _mm_loadu_ps(values + i);
+                const __m128 inside = _mm_and_ps(_mm_cmpge_ps(value4, lo4), _mm_cmple_ps(value4, hi4));
+                bits |= static_cast<uint32_t>(_mm_movemask_ps(inside)) << (i - first);
+            }
+#endif
+            for(; i < last; ++i)
+            {
+                const uint32_t inside = (values[i] >= lo) & (values[i] <= hi);
+                bits |= inside << (i - first);
+            }
+            mask[word] = bits;
+        }
+    }
+
+    /**
+     * @brief Constrain a buffer of values to the range, in and out may alias
+     */
+    void constrain(const float *in, float *out, const size_t count) const noexcept
+    {
+        const float lo = low.get();
+        const float hi = high.get();
+        for(size_t i = 0; i < count; ++i)
+        {
+            out[i] = std::min(std::max(in[i], lo), hi);
+        }
+    }
+
   private:
     nt::RangeLow  low;
     nt::RangeHigh high;
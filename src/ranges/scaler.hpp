@@ -35,6 +35,7 @@
 
 #include "range.hpp"
 #include "util/namedtype.hpp"
+#include <cstddef>
 
 namespace deepnote
 {
@@ -77,6 +78,28 @@ struct Scaler
         return (normalize(value) * output.length()) + output.get_low().get();
     }
 
+    /**
+     * @brief Scale a buffer of values, in and out may alias
+     *
+     * Same arithmetic as operator(), so results are identical, with the range
+     * bounds loaded once so the loop vectorizes.
+     */
+    void scale(const float *in, float *out, const size_t count) const noexcept
+    {
+        const float in_low     = input.get_low().get();
+        const float in_length  = input.length();
+        const float out_low    = output.get_low().get();
+        const float out_length = output.length();
+        for(size_t i = 0; i < count; ++i)
+        {
+            out[i] = ((in[i] - in_low) / in_length * out_length) + out_low;
+        }
+    }
+
+    const Range &get_input() const noexcept { return input; }
+
+    const Range &get_output() const noexcept { return output; }
+
   private:
     float normalize(const float value) const { return (value - input.get_low().get()) / input.length(); }
 
@@ -81,6 +81,10 @@ struct BezierUnitShaper
         return y;
     }
 
+    nt::ControlPoint1 get_control_point1() const noexcept { return nt::ControlPoint1(y2); }
+
+    nt::ControlPoint2 get_control_point2() const noexcept { return nt::ControlPoint2(y3); }
+
   private:
     float y1{0.f}; //  start point
     float y2{0.f}; //  control point 1
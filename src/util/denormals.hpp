@@ -0,0 +1,127 @@
+/**
+ * @file denormals.hpp
+ * @brief Scoped denormal protection for the Deep Note synthesizer render paths
+ *
+ * This file provides ScopedFlushDenormals, an RAII guard that switches the
+ * floating point unit to flush-to-zero / denormals-are-zero for the lifetime
+ * of the guard and restores the previous mode when it goes out of scope.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DEEPNOTE_DENORMALS_SSE
+#elif defined(__aarch64__)
+#define DEEPNOTE_DENORMALS_AARCH64
+#elif defined(__arm__) && defined(__VFP_FP__) && !defined(__SOFTFP__)
+#define DEEPNOTE_DENORMALS_ARM_VFP
+#endif
+
+namespace deepnote
+{
+
+/**
+ * @brief Flush denormals to zero for the lifetime of the guard
+ *
+ * Long decays and tiny detune offsets can leave denormal values in the
+ * accumulation paths, which many CPUs process orders of magnitude slower than
+ * normal values. Block and ensemble render entry points hold one of these for
+ * the duration of the render.
+ *
+ * - x86: sets FTZ and DAZ in MXCSR
+ * - AArch64: sets FZ in FPCR
+ * - ARM VFP (e.g. Cortex-M7 on Daisy Seed): sets FZ in FPSCR
+ * - Anything else: no-op
+ *
+ * Guards nest; each restores the mode that was active when it was created.
+ */
+struct ScopedFlushDenormals
+{
+    ScopedFlushDenormals() noexcept
+        : previous_mode(read_mode())
+    {
+        write_mode(previous_mode | FLUSH_MASK);
+    }
+
+    ~ScopedFlushDenormals() { write_mode(previous_mode); }
+
+    ScopedFlushDenormals(const ScopedFlushDenormals &other)            = delete;
+    ScopedFlushDenormals &operator=(const ScopedFlushDenormals &other) = delete;
+
+    /**
+     * @brief Whether the target has a flush-to-zero mode the guard can set
+     */
+    static constexpr bool is_supported() noexcept { return FLUSH_MASK != 0; }
+
+  private:
+#if defined(DEEPNOTE_DENORMALS_SSE)
+    using ModeType                       = uint32_t;
+    static constexpr ModeType FLUSH_MASK = 0x8040; //  FTZ (bit 15) | DAZ (bit 6)
+
+    static ModeType read_mode() noexcept { return _mm_getcsr(); }
+
+    static void write_mode(const ModeType mode) noexcept { _mm_setcsr(mode); }
+#elif defined(DEEPNOTE_DENORMALS_AARCH64)
+    using ModeType                       = uint64_t;
+    static constexpr ModeType FLUSH_MASK = ModeType(1) << 24; //  FZ
+
+    static ModeType read_mode() noexcept
+    {
+        ModeType mode;
+        asm volatile("mrs %0, fpcr" : "=r"(mode));
+        return mode;
+    }
+
+    static void write_mode(const ModeType mode) noexcept { asm volatile("msr fpcr, %0" : : "r"(mode)); }
+#elif defined(DEEPNOTE_DENORMALS_ARM_VFP)
+    using ModeType                       = uint32_t;
+    static constexpr ModeType FLUSH_MASK = ModeType(1) << 24; //  FZ
+
+    static ModeType read_mode() noexcept
+    {
+        ModeType mode;
+        asm volatile("vmrs %0, fpscr" : "=r"(mode));
+        return mode;
+    }
+
+    static void write_mode(const ModeType mode) noexcept { asm volatile("vmsr fpscr, %0" : : "r"(mode)); }
+#else
+    using ModeType                       = uint32_t;
+    static constexpr ModeType FLUSH_MASK = 0;
+
+    static ModeType read_mode() noexcept { return 0; }
+
+    static void write_mode(const ModeType mode) noexcept {}
+#endif
+
+    ModeType previous_mode;
+};
+
+} // namespace deepnote
@@ -0,0 +1,142 @@
+/**
+ * @file spscqueue.hpp
+ * @brief Wait-free single producer, single consumer queue
+ *
+ * This file provides SpscQueue, a fixed capacity ring buffer for passing
+ * small values from the audio thread to a control thread, or back, without
+ * locks or allocation.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "util/cacheline.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace deepnote
+{
+
+/**
+ * @brief Fixed capacity wait-free queue for one producer and one consumer thread
+ *
+ * try_push() and try_pop() each complete in a bounded number of steps and
+ * never block. When the queue is full try_push() drops the value and counts
+ * it, so a stalled consumer can't stall the producer. Each side caches the
+ * other side's index and only reloads it when the queue looks full or empty,
+ * and the two sides' indices are kept on separate cache lines, so in the
+ * common case neither side touches a line the other is writing.
+ *
+ * @tparam T Trivially copyable value type
+ * @tparam Capacity Number of values, a power of two
+ */
+template <typename T, size_t Capacity> class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+    SpscQueue() noexcept = default;
+
+    SpscQueue(const SpscQueue &other)            = delete;
+    SpscQueue &operator=(const SpscQueue &other) = delete;
+
+    /**
+     * @brief Append a value, producer thread only
+     * @return false if the queue was full and the value was dropped
+     */
+    bool try_push(const T &value) noexcept
+    {
+        const uint64_t write = write_index.load(std::memory_order_relaxed);
+        if(write - cached_read_index == Capacity)
+        {
+            cached_read_index = read_index.load(std::memory_order_acquire);
+            if(write - cached_read_index == Capacity)
+            {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots[write & (Capacity - 1)] = value;
+        write_index.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest value, consumer thread only
+     * @return false if the queue was empty
+     */
+    bool try_pop(T &value) noexcept
+    {
+        const uint64_t read = read_index.load(std::memory_order_relaxed);
+        if(read == cached_write_index)
+        {
+            cached_write_index = write_index.load(std::memory_order_acquire);
+            if(read == cached_write_index)
+            {
+                return false;
+            }
+        }
+        value = slots[read & (Capacity - 1)];
+        read_index.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Number of values queued, exact only when called from either side with the other idle
+     */
+    size_t size() const noexcept
+    {
+        return static_cast<size_t>(write_index.load(std::memory_order_acquire) -
+                                   read_index.load(std::memory_order_acquire));
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    /**
+     * @brief Number of values try_push() has dropped because the queue was full
+     */
+    uint64_t get_dropped() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+    static constexpr size_t capacity() noexcept { return Capacity; }
+
+  private:
+    //  producer side
+    std::atomic<uint64_t> write_index{0};
+    uint64_t              cached_read_index{0};
+    std::atomic<uint64_t> dropped{0};
+    char                  producer_padding[constants::CACHE_LINE_SIZE];
+
+    //  consumer side
+    std::atomic<uint64_t> read_index{0};
+    uint64_t              cached_write_index{0};
+    char                  consumer_padding[constants::CACHE_LINE_SIZE];
+
+    std::array<T, Capacity> slots{};
+};
+
+} // namespace deepnote
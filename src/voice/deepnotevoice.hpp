@@ -2,7 +2,7 @@
  * @file deepnotevoice.hpp
  * @brief Core voice implementation for the THX Deep Note effect synthesizer
  *
- * This file contains the DeepnoteVoice class which manages multiple detuned oscillators
+ * This file contains the BasicDeepnoteVoice class which manages multiple detuned oscillators
  * for creating the classic THX Deep Note sound. Features include non-linear frequency
  * transitions via Bezier curves, state-based animation system, and LFO-driven modulation.
  *
@@ -33,14 +33,21 @@
 
 #pragma once
 
-#include "Synthesis/oscillator.h"
 #include "oscfrequency.hpp"
+#include "oscillators/sawoscillator.hpp"
+#include "oscillators/wavetable.hpp"
 #include "ranges/range.hpp"
 #include "ranges/scaler.hpp"
 #include "unitshapers/bezier.hpp"
+#include "util/denormals.hpp"
+#include "util/fastmath.hpp"
+#include "util/random.hpp"
+#include "voice/detune.hpp"
 #include "voice/frequencytable.hpp"
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 
@@ -52,6 +59,11 @@ static constexpr float  DEFAULT_LFO_AMPLITUDE      = 0.5f;
 static constexpr float  DEFAULT_DETUNE_HZ          = 2.5f;
 static constexpr float  TARGET_FREQUENCY_TOLERANCE = 1.0f;
 static constexpr size_t NEAR_BEGINNING_SAMPLES     = 4800;
+static constexpr size_t ANTIALIAS_UPDATE_INTERVAL  = 32;
+static constexpr size_t DEFAULT_MAX_OSCILLATORS    = 16;
+
+//  Pitch transits can't start or end at 0Hz, frequencies below this are raised to it
+static constexpr float PITCH_TRANSIT_MIN_FREQUENCY = 0.5f;
 } // namespace constants
 
 namespace nt
@@ -70,10 +82,32 @@ struct NoopTrace
     template <typename T> void operator()(T value) const {}
 };
 
+/**
+ * @brief Members shared by every voice regardless of oscillator capacity
+ *
+ * Keeping State outside the template means voices of different capacities
+ * report, and can be compared by, the same state type.
+ */
+struct DeepnoteVoiceBase
+{
+    enum State
+    {
+        PENDING_TRANSIT_TO_TARGET,
+        IN_TRANSIT_TO_TARGET,
+        AT_TARGET
+    };
+
+    enum TransitMode
+    {
+        LINEAR_TRANSIT, //  equal steps of the animation cover equal distances in Hz
+        PITCH_TRANSIT   //  equal steps of the animation cover equal musical intervals
+    };
+};
+
 /**
  * @brief A synthesizer voice implementing the THX Deep Note effect
  *
- * The DeepnoteVoice manages multiple detuned oscillators that can smoothly
+ * The voice manages multiple detuned oscillators that can smoothly
  * transition between frequencies using an animated LFO and Bezier curve shaping.
  *
  * Key features:
@@ -86,21 +120,26 @@ struct NoopTrace
  * 1. Call init_voice() to set up the voice with desired parameters
  * 2. Set target frequencies using set_target_frequency()
  * 3. Call process_voice() in your audio loop to generate samples
+ *
+ * Storage for MaxOscillators oscillators is reserved inline, so size the
+ * template to the configuration in use. DeepnoteVoice is the 16 oscillator
+ * voice. When a voice is initialised with exactly MaxOscillators oscillators
+ * the oscillator loop has a compile-time trip count and is fully unrolled.
+ * Each oscillator of capacity costs 17 bytes, its SawOscillatorBank entry
+ * and detune, and footprint<>() in ensemble/footprint.hpp reports the total.
+ *
+ * @tparam MaxOscillators Oscillator capacity of the voice
  */
-struct DeepnoteVoice
+template <size_t MaxOscillators> struct BasicDeepnoteVoice : DeepnoteVoiceBase
 {
-    static constexpr size_t MAX_OSCILLATORS = 16;
-    const float             LFO_AMPLITUDE{constants::DEFAULT_LFO_AMPLITUDE};
+    static_assert(MaxOscillators > 0, "A voice needs at least one oscillator");
+    static_assert(MaxOscillators <= UINT16_MAX, "Oscillator count is stored as uint16_t");
+    static_assert(constants::ANTIALIAS_UPDATE_INTERVAL <= UINT8_MAX, "Countdown is stored as uint8_t");
 
-    enum State
-    {
-        PENDING_TRANSIT_TO_TARGET,
-        IN_TRANSIT_TO_TARGET,
-        AT_TARGET
-    };
+    static constexpr size_t MAX_OSCILLATORS = MaxOscillators;
+    static constexpr float  LFO_AMPLITUDE   = constants::DEFAULT_LFO_AMPLITUDE;
 
-    DeepnoteVoice()          = default;
-    virtual ~DeepnoteVoice() = default;
+    BasicDeepnoteVoice() = default;
 
     nt::OscillatorFrequency get_target_frequency() const noexcept { return target_frequency; }
 
@@ -116,6 +155,8 @@ struct DeepnoteVoice
         this->start_frequency  = this->current_frequency;
         this->target_frequency = freq;
         this->state            = PENDING_TRANSIT_TO_TARGET;
+        this->steady_state     = false;
+        update_pitch_transit();
     }
 
     nt::OscillatorFrequency get_start_frequency() const noexcept { return start_frequency; }
@@ -131,11 +172,17 @@ struct DeepnoteVoice
         this->start_frequency   = freq;
         this->current_frequency = this->start_frequency;
         this->state             = PENDING_TRANSIT_TO_TARGET;
+        this->steady_state      = false;
+        update_pitch_transit();
     }
 
     nt::OscillatorFrequency get_current_frequency() const noexcept { return current_frequency; }
 
-    void set_current_frequency(const nt::OscillatorFrequency freq) noexcept { this->current_frequency = freq; }
+    void set_current_frequency(const nt::OscillatorFrequency freq) noexcept
+    {
+        this->current_frequency = freq;
+        this->steady_state      = false;
+    }
 
     void scale_lfo_base_freq(const nt::AnimationMultiplier mulitplier)
     {
@@ -144,18 +191,93 @@ struct DeepnoteVoice
             throw std::invalid_argument("Animation multiplier must be non-negative");
         }
 
-        lfo.SetFreq(lfo_base_freq.get() * mulitplier.get());
+        lfo_phase_inc = lfo_phase_increment(mulitplier);
+    }
+
+    /**
+     * @brief Per-sample LFO phase increment for a multiplier, as the LFO computes it
+     */
+    float lfo_phase_increment(const nt::AnimationMultiplier multiplier) const noexcept
+    {
+        return lfo_base_freq.get() * multiplier.get() * lfo_sr_recip;
     }
 
+    /**
+     * @brief Seconds per LFO sample, 1 / sample rate
+     */
+    float get_lfo_sr_recip() const noexcept { return lfo_sr_recip; }
+
+    /**
+     * @brief Phase increment the LFO advanced by on its last sample
+     */
+    float get_lfo_phase_inc() const noexcept { return lfo_phase_inc; }
+
+    /**
+     * @brief Unshaped animation value of the last sample, 0 at the start of a transit
+     */
+    float get_lfo_position() const noexcept { return lfo_position; }
+
     nt::OscillatorFrequency get_lfo_base_freq() const noexcept { return lfo_base_freq; }
 
     void set_lfo_base_freq(const nt::OscillatorFrequency freq) noexcept { this->lfo_base_freq = freq; }
 
+    /**
+     * @brief Choose whether transits glide linearly in Hz or in pitch
+     *
+     * PITCH_TRANSIT interpolates in log2 frequency so equal steps of the shaped
+     * animation are equal musical intervals. The log2 ratio is computed when
+     * the transit is set up, leaving one fast_exp2() per sample.
+     *
+     * @param mode LINEAR_TRANSIT (default) or PITCH_TRANSIT
+     */
+    void set_transit_mode(const TransitMode mode) noexcept
+    {
+        transit_mode = mode;
+        update_pitch_transit();
+    }
+
+    TransitMode get_transit_mode() const noexcept { return transit_mode; }
+
+    /**
+     * @brief Frequency of a pitch transit for a shaped animation value
+     * @param shaped_value Shaped animation value, 0 at start and 1 at target
+     */
+    nt::OscillatorFrequency pitch_transit_frequency(const float shaped_value) const noexcept
+    {
+        return nt::OscillatorFrequency(pitch_transit_base * fast_exp2(shaped_value * pitch_transit_log2_ratio));
+    }
+
+    /**
+     * @brief Shaped animation value at which the transit passes a frequency
+     *
+     * Inverts the transit's frequency law, linear or pitch: 0 at the start
+     * frequency and 1 at the target, outside [0, 1] for frequencies beyond
+     * them. A transit that doesn't move is treated as already at 1.
+     *
+     * @param freq Frequency to locate
+     */
+    float transit_position(const nt::OscillatorFrequency freq) const noexcept
+    {
+        if(transit_mode == PITCH_TRANSIT)
+        {
+            return (pitch_transit_log2_ratio != 0.f)
+                       ? std::log2(std::max(freq.get(), constants::PITCH_TRANSIT_MIN_FREQUENCY) / pitch_transit_base) /
+                             pitch_transit_log2_ratio
+                       : 1.f;
+        }
+        const float span = target_frequency.get() - start_frequency.get();
+        return (span != 0.f) ? (freq.get() - start_frequency.get()) / span : 1.f;
+    }
+
     bool is_at_target() const noexcept { return state == AT_TARGET; }
 
     State get_state() const noexcept { return state; }
 
-    void set_state(const State state) noexcept { this->state = state; }
+    void set_state(const State state) noexcept
+    {
+        this->state        = state;
+        this->steady_state = false;
+    }
 
     void init_lfo(const nt::SampleRate sample_rate, const nt::OscillatorFrequency base_freq)
     {
@@ -169,15 +291,27 @@ struct DeepnoteVoice
         }
 
         lfo_base_freq = base_freq;
-        lfo.Init(sample_rate.get());
-        lfo.SetAmp(LFO_AMPLITUDE);
-        lfo.SetWaveform(daisysp::Oscillator::WAVE_RAMP);
-        lfo.SetFreq(lfo_base_freq.get());
+        lfo_sr_recip  = 1.f / sample_rate.get();
+        lfo_phase_inc = lfo_base_freq.get() * lfo_sr_recip;
+        lfo_phase     = 0.f;
     }
 
-    nt::OscillatorValue process_lfo() { return nt::OscillatorValue(lfo.Process() + LFO_AMPLITUDE); }
+    //  A rising ramp from 0 to 1, the same values daisysp::Oscillator's WAVE_RAMP
+    //  gives at LFO_AMPLITUDE once offset, without keeping its amplitude,
+    //  waveform and sample rate in every voice
+    nt::OscillatorValue process_lfo() noexcept
+    {
+        const float ramp = (lfo_phase * 2.0f) - 1.0f;
+        lfo_phase += lfo_phase_inc;
+        if(lfo_phase > 1.0f)
+        {
+            lfo_phase -= 1.0f;
+        }
+        lfo_position = ramp * LFO_AMPLITUDE + LFO_AMPLITUDE;
+        return nt::OscillatorValue(lfo_position);
+    }
 
-    void reset_lfo() noexcept { lfo.Reset(); }
+    void reset_lfo() noexcept { lfo_phase = 0.f; }
 
     void init_oscillators(const size_t count, nt::SampleRate sample_rate, nt::OscillatorFrequency start_frequency)
     {
@@ -198,74 +332,334 @@ struct DeepnoteVoice
             throw std::invalid_argument("Start frequency must be non-negative");
         }
 
-        oscillator_count = count;
+        oscillator_count    = static_cast<uint16_t>(count);
+        antialias_countdown = 0;
+        steady_state        = false;
+        sr_recip            = 1.f / sample_rate.get();
+        increments_dirty    = true;
         for(size_t i = 0; i < oscillator_count; ++i)
         {
-            oscillators[i].oscillator.Init(sample_rate.get());
-            oscillators[i].oscillator.SetWaveform(daisysp::Oscillator::WAVE_POLYBLEP_SAW);
-            oscillators[i].oscillator.SetFreq(start_frequency.get());
-            oscillators[i].detune_amount = 0.f;
+            oscillators.reset(i);
+            oscillators.set_phase_inc(i, start_frequency.get() * sr_recip);
+            detune_ratios[i] = 1.f;
+            detune_incs[i]   = 0.f;
         }
     }
 
+    /**
+     * @brief Enable or disable per-oscillator anti-aliasing kernel selection
+     *
+     * When enabled (the default) each oscillator uses the cheapest kernel that is
+     * alias-free at its current frequency, re-evaluated every
+     * ANTIALIAS_UPDATE_INTERVAL samples. When disabled every oscillator uses PolyBLEP.
+     *
+     * @param enabled true to select kernels from frequency, false for fixed PolyBLEP
+     */
+    void set_adaptive_antialiasing(const bool enabled) noexcept
+    {
+        adaptive_antialiasing = enabled;
+        antialias_countdown   = 0;
+        steady_state          = false;
+    }
+
+    bool is_adaptive_antialiasing() const noexcept { return adaptive_antialiasing; }
+
+    /**
+     * @brief Render the oscillators from band-limited wavetables
+     *
+     * When a table is set the oscillators read from it instead of running a
+     * BLEP kernel, and adaptive anti-aliasing is not used. The table is not
+     * owned by the voice and is typically SawWavetable::shared().
+     *
+     * @param table Wavetable to render from, or nullptr for BLEP kernels
+     */
+    void set_wavetable(const SawWavetable *table) noexcept
+    {
+        wavetable    = table;
+        steady_state = false;
+    }
+
+    const SawWavetable *get_wavetable() const noexcept { return wavetable; }
+
     /**
      * @brief Detune oscillators symmetrically around the fundamental frequency
      *
-     * Distributes oscillators either side of the fundamental frequency using
-     * integer multiples of the detune amount. For N oscillators:
-     * - Single oscillator: no detuning (detune_amount = 0)
+     * Distributes oscillators either side of the fundamental frequency by a
+     * fixed number of Hz per step. With LINEAR_SPREAD, for N oscillators:
+     * - Single oscillator: no detuning
      * - Multiple oscillators: distributed as ..., -2*detune, -detune, +detune, +2*detune, ...
      *
+     * A fixed offset in Hz is a wide interval at low frequencies and a narrow
+     * one at high frequencies; detune by nt::DetuneCents for a constant interval.
+     *
      * @param detune Detuning amount in Hz for each step
+     * @param spread How steps are spaced, see DetuneSpread
      */
-    void detune_oscillators(const nt::DetuneHz detune)
+    void detune_oscillators(const nt::DetuneHz detune, const DetuneSpread spread = LINEAR_SPREAD)
     {
-        // If we only have one oscillator, we don't need to detune it
-        // Otherwise distribute the either side of the fundamental frequency by an
-        // integer muliples of detune.
-        const auto half = oscillator_count / 2;
+        steady_state     = false;
+        increments_dirty = true;
         for(size_t i = 0; i < oscillator_count; ++i)
         {
-            if(oscillator_count <= 1)
-            {
-                oscillators[i].detune_amount = 0.f;
-            }
-            else
+            detune_ratios[i] = 1.f;
+            detune_incs[i]   = detune_step(spread, i, oscillator_count) * detune.get() * sr_recip;
+        }
+    }
+
+    /**
+     * @brief Detune oscillators by a musical interval per step
+     *
+     * Each oscillator's frequency is the fundamental times a multiplier
+     * computed here, so the voice keeps the same interval between oscillators
+     * at every frequency and a transit doesn't change how fast they beat
+     * relative to the pitch.
+     *
+     * @param detune Detuning interval in cents for each step
+     * @param spread How steps are spaced, see DetuneSpread
+     */
+    void detune_oscillators(const nt::DetuneCents detune, const DetuneSpread spread = LINEAR_SPREAD)
+    {
+        steady_state     = false;
+        increments_dirty = true;
+        for(size_t i = 0; i < oscillator_count; ++i)
+        {
+            detune_ratios[i] = cents_to_ratio(detune_step(spread, i, oscillator_count) * detune.get());
+            detune_incs[i]   = 0.f;
+        }
+    }
+
+    /**
+     * @brief Detune oscillators by a frequency ratio per step
+     * @param detune Ratio for each step, e.g. 1.002 for about 3.5 cents
+     * @param spread How steps are spaced, see DetuneSpread
+     */
+    void detune_oscillators(const nt::DetuneRatio detune, const DetuneSpread spread = LINEAR_SPREAD)
+    {
+        detune_oscillators(nt::DetuneCents(ratio_to_cents(detune.get())), spread);
+    }
+
+    /**
+     * @brief Detune oscillators by random amounts
+     *
+     * Each oscillator is detuned by a value drawn uniformly from the span the
+     * symmetric distribution covers, +/- (oscillator count / 2) * detune, so
+     * the oscillators drift apart irregularly as in the original Deep Note.
+     * One value is drawn per oscillator, a single oscillator is not detuned.
+     *
+     * @param detune Detuning amount in Hz for each step
+     * @param random Stream to draw from, typically keyed by voice index
+     */
+    void detune_oscillators(const nt::DetuneHz detune, RandomStream &random)
+    {
+        steady_state     = false;
+        increments_dirty = true;
+        const float span = static_cast<float>(oscillator_count / 2) * detune.get();
+        for(size_t i = 0; i < oscillator_count; ++i)
+        {
+            detune_ratios[i] = 1.f;
+            detune_incs[i]   = random.next_uniform(-span, span) * sr_recip;
+        }
+    }
+
+    size_t get_oscillator_count() const noexcept { return oscillator_count; }
+
+    /**
+     * @brief Frequency of an oscillator for the current fundamental, including detune
+     * @param index Oscillator index, 0 to get_oscillator_count() - 1
+     */
+    nt::OscillatorFrequency get_oscillator_frequency(const size_t index) const noexcept
+    {
+        return nt::OscillatorFrequency(current_frequency.get() * detune_ratios[index] + detune_incs[index] / sr_recip);
+    }
+
+    nt::OscillatorValue process_oscillators()
+    {
+        //  a full bank has a compile-time trip count, letting the loop unroll
+        if(oscillator_count == MaxOscillators)
+        {
+            return (wavetable != nullptr) ? process_wavetable_oscillators<true>() : process_blep_oscillators<true>();
+        }
+        return (wavetable != nullptr) ? process_wavetable_oscillators<false>() : process_blep_oscillators<false>();
+    }
+
+    /**
+     * @brief Whether the voice is at target with nothing changed since it got there
+     *
+     * While steady, process_voice() skips the transit logic and
+     * process_steady_oscillators() runs the oscillators on their existing
+     * phase increments. Any setter that affects frequency, state or the
+     * oscillators clears it.
+     */
+    bool is_steady_state() const noexcept { return steady_state; }
+
+    /**
+     * @brief Enter the steady state once the voice has settled at target
+     *
+     * Oscillator frequencies must already be at target, i.e. process_oscillators()
+     * has run with the target frequency. Anti-aliasing kernels are chosen once
+     * here since they can't change until the voice leaves the steady state.
+     */
+    void settle_at_target() noexcept
+    {
+        if(state != AT_TARGET)
+        {
+            return;
+        }
+
+        for(size_t i = 0; i < oscillator_count; ++i)
+        {
+            oscillators.set_kernel(i, adaptive_antialiasing ? SawOscillator::select_kernel(oscillators.get_phase_inc(i))
+                                                            : SawOscillator::POLYBLEP);
+        }
+        steady_state = true;
+    }
+
+    /**
+     * @brief Advance the oscillators on their current phase increments
+     *
+     * Only valid while is_steady_state().
+     */
+    nt::OscillatorValue process_steady_oscillators() noexcept
+    {
+        if(oscillator_count == MaxOscillators)
+        {
+            return (wavetable != nullptr) ? advance_wavetable_oscillators<true>() : advance_blep_oscillators<true>();
+        }
+        return (wavetable != nullptr) ? advance_wavetable_oscillators<false>() : advance_blep_oscillators<false>();
+    }
+
+  private:
+    //  Phase increments only change when the frequency or detune does. The base
+    //  increment is computed once and each oscillator scales it by its detune
+    //  ratio and adds its detune increment, both precomputed, rather than every
+    //  oscillator multiplying its own detuned frequency by the sample period.
+    //  The ratios, offsets and the bank's increments are all separate arrays,
+    //  so the multiply-add runs as one vector loop. Hz detune leaves the ratios at 1
+    //  and cents detune leaves the increments at 0, so both give exactly the
+    //  increments they would on their own.
+    template <bool FullBank> void update_increments() noexcept
+    {
+        if(!increments_dirty && current_frequency.get() == applied_frequency)
+        {
+            return;
+        }
+
+        const size_t count    = FullBank ? MaxOscillators : oscillator_count;
+        const float  base_inc = current_frequency.get() * sr_recip;
+        for(size_t i = 0; i < count; ++i)
+        {
+            oscillators.set_phase_inc(i, base_inc * detune_ratios[i] + detune_incs[i]);
+        }
+        applied_frequency = current_frequency.get();
+        increments_dirty  = false;
+    }
+
+    template <bool FullBank> nt::OscillatorValue process_blep_oscillators()
+    {
+        const size_t count = FullBank ? MaxOscillators : oscillator_count;
+        update_increments<FullBank>();
+
+        //  anti-aliasing kernels are chosen at control rate rather than every sample
+        const bool select_kernels = (antialias_countdown == 0);
+        if(select_kernels)
+        {
+            antialias_countdown = static_cast<uint8_t>(constants::ANTIALIAS_UPDATE_INTERVAL);
+        }
+        --antialias_countdown;
+
+        float osc_value{0.f};
+        for(size_t i = 0; i < count; ++i)
+        {
+            if(select_kernels)
             {
-                const int8_t idx             = i - half + ((i >= half) ? 1 : 0);
-                oscillators[i].detune_amount = idx * detune.get();
+                oscillators.set_kernel(i, adaptive_antialiasing
+                                              ? SawOscillator::select_kernel(oscillators.get_phase_inc(i))
+                                              : SawOscillator::POLYBLEP);
             }
+            osc_value += oscillators.process(i);
         }
+        return nt::OscillatorValue(osc_value);
     }
 
-    nt::OscillatorValue process_oscillators()
+    template <bool FullBank> nt::OscillatorValue process_wavetable_oscillators()
     {
+        const size_t count = FullBank ? MaxOscillators : oscillator_count;
+        update_increments<FullBank>();
+
         float osc_value{0.f};
-        for(size_t i = 0; i < oscillator_count; ++i)
+        for(size_t i = 0; i < count; ++i)
         {
-            oscillators[i].oscillator.SetFreq(current_frequency.get() + oscillators[i].detune_amount);
-            osc_value += oscillators[i].oscillator.Process();
+            osc_value += oscillators.process(i, *wavetable);
         }
         return nt::OscillatorValue(osc_value);
     }
 
-  private:
-    struct DetunedOscillator
+    void update_pitch_transit() noexcept
     {
-        daisysp::Oscillator oscillator;
-        float               detune_amount;
-    };
+        if(transit_mode != PITCH_TRANSIT)
+        {
+            return;
+        }
+        pitch_transit_base = std::max(start_frequency.get(), constants::PITCH_TRANSIT_MIN_FREQUENCY);
+        pitch_transit_log2_ratio =
+            std::log2(std::max(target_frequency.get(), constants::PITCH_TRANSIT_MIN_FREQUENCY) / pitch_transit_base);
+    }
+
+    template <bool FullBank> nt::OscillatorValue advance_blep_oscillators() noexcept
+    {
+        const size_t count = FullBank ? MaxOscillators : oscillator_count;
+
+        float osc_value{0.f};
+        for(size_t i = 0; i < count; ++i)
+        {
+            osc_value += oscillators.process(i);
+        }
+        return nt::OscillatorValue(osc_value);
+    }
 
-    State                                          state{PENDING_TRANSIT_TO_TARGET};
-    nt::OscillatorFrequency                        start_frequency{0.f};
-    nt::OscillatorFrequency                        target_frequency{0.f};
-    nt::OscillatorFrequency                        current_frequency{0.f};
-    std::array<DetunedOscillator, MAX_OSCILLATORS> oscillators{};
-    size_t                                         oscillator_count{0};
-    nt::OscillatorFrequency                        lfo_base_freq{0.f};
-    daisysp::Oscillator                            lfo;
+    template <bool FullBank> nt::OscillatorValue advance_wavetable_oscillators() noexcept
+    {
+        const size_t count = FullBank ? MaxOscillators : oscillator_count;
+
+        float osc_value{0.f};
+        for(size_t i = 0; i < count; ++i)
+        {
+            osc_value += oscillators.process(i, *wavetable);
+        }
+        return nt::OscillatorValue(osc_value);
+    }
+
+    //  Pointer and 4-byte fields first and the bytes last, so only the tail pads
+    const SawWavetable                *wavetable{nullptr};
+    State                              state{PENDING_TRANSIT_TO_TARGET};
+    nt::OscillatorFrequency            start_frequency{0.f};
+    nt::OscillatorFrequency            target_frequency{0.f};
+    nt::OscillatorFrequency            current_frequency{0.f};
+    float                              sr_recip{0.f};
+    float                              applied_frequency{0.f};
+    TransitMode                        transit_mode{LINEAR_TRANSIT};
+    float                              pitch_transit_base{constants::PITCH_TRANSIT_MIN_FREQUENCY};
+    float                              pitch_transit_log2_ratio{0.f};
+    nt::OscillatorFrequency            lfo_base_freq{0.f};
+    float                              lfo_sr_recip{0.f};
+    float                              lfo_phase_inc{0.f};
+    float                              lfo_phase{0.f};
+    float                              lfo_position{0.f};
+    std::array<float, MAX_OSCILLATORS> detune_ratios{};
+    std::array<float, MAX_OSCILLATORS> detune_incs{};
+    SawOscillatorBank<MAX_OSCILLATORS> oscillators{};
+    uint16_t                           oscillator_count{0};
+    uint8_t                            antialias_countdown{0};
+    bool                               adaptive_antialiasing{true};
+    bool                               steady_state{false};
+    bool                               increments_dirty{true};
 };
 
+template <size_t MaxOscillators> constexpr size_t BasicDeepnoteVoice<MaxOscillators>::MAX_OSCILLATORS;
+template <size_t MaxOscillators> constexpr float  BasicDeepnoteVoice<MaxOscillators>::LFO_AMPLITUDE;
+
+using DeepnoteVoice = BasicDeepnoteVoice<constants::DEFAULT_MAX_OSCILLATORS>;
+
 /**
  * @brief Initialize a DeepnoteVoice with specified parameters
  *
@@ -276,10 +670,11 @@ struct DeepnoteVoice
  * @param lfo_frequency Base LFO frequency for animation in Hz
  * @param detune Oscillator detuning amount in Hz (default: 2.5 Hz)
  */
-inline void init_voice(DeepnoteVoice &voice, const size_t oscillator_count,
-                       const nt::OscillatorFrequency start_frequency, const nt::SampleRate sample_rate,
-                       const nt::OscillatorFrequency lfo_frequency,
-                       const nt::DetuneHz            detune = nt::DetuneHz(constants::DEFAULT_DETUNE_HZ))
+template <size_t MaxOscillators>
+void init_voice(BasicDeepnoteVoice<MaxOscillators> &voice, const size_t oscillator_count,
+                const nt::OscillatorFrequency start_frequency, const nt::SampleRate sample_rate,
+                const nt::OscillatorFrequency lfo_frequency,
+                const nt::DetuneHz            detune = nt::DetuneHz(constants::DEFAULT_DETUNE_HZ))
 {
     voice.set_start_frequency(start_frequency);
     voice.set_current_frequency(start_frequency);
@@ -290,9 +685,37 @@ inline void init_voice(DeepnoteVoice &voice, const size_t oscillator_count,
     voice.detune_oscillators(detune);
 }
 
+/**
+ * @brief Initialize a DeepnoteVoice at a random start frequency with random detuning
+ *
+ * Draws the start frequency from start_range and then one detune value per
+ * oscillator, see BasicDeepnoteVoice::detune_oscillators(). Voices given
+ * RandomStreams with the same seed and stream are initialized identically.
+ *
+ * @param voice Voice instance to initialize
+ * @param oscillator_count Number of oscillators (1 to MAX_OSCILLATORS)
+ * @param start_range Range to draw the initial frequency from, in Hz
+ * @param sample_rate Audio sample rate in Hz
+ * @param lfo_frequency Base LFO frequency for animation in Hz
+ * @param detune Oscillator detuning amount in Hz for each step
+ * @param random Stream to draw from, typically keyed by voice index
+ */
+template <size_t MaxOscillators>
+void init_voice(BasicDeepnoteVoice<MaxOscillators> &voice, const size_t oscillator_count, const Range &start_range,
+                const nt::SampleRate sample_rate, const nt::OscillatorFrequency lfo_frequency,
+                const nt::DetuneHz detune, RandomStream &random)
+{
+    const nt::OscillatorFrequency start_frequency(
+        random.next_uniform(start_range.get_low().get(), start_range.get_high().get()));
+    init_voice(voice, oscillator_count, start_frequency, sample_rate, lfo_frequency, detune);
+    voice.detune_oscillators(detune, random);
+}
+
 namespace
 {
-nt::OscillatorFrequency calculate_shaped_frequency(DeepnoteVoice &voice, const nt::AnimationMultiplier lfo_multiplier,
+template <size_t MaxOscillators>
+nt::OscillatorFrequency calculate_shaped_frequency(BasicDeepnoteVoice<MaxOscillators> &voice,
+                                                   const nt::AnimationMultiplier lfo_multiplier,
                                                    const nt::ControlPoint1 cp1, const nt::ControlPoint2 cp2)
 {
 
@@ -300,6 +723,11 @@ nt::OscillatorFrequency calculate_shaped_frequency(DeepnoteVoice &voice, const n
     const auto raw_lfo_value    = voice.process_lfo();
     auto       shaped_lfo_value = nt::OscillatorValue(BezierUnitShaper(cp1, cp2)(raw_lfo_value.get()));
 
+    if(voice.get_transit_mode() == DeepnoteVoiceBase::PITCH_TRANSIT)
+    {
+        return voice.pitch_transit_frequency(shaped_lfo_value.get());
+    }
+
     const auto start_frequency  = voice.get_start_frequency();
     const auto target_frequency = voice.get_target_frequency();
 
@@ -317,8 +745,10 @@ nt::OscillatorFrequency calculate_shaped_frequency(DeepnoteVoice &voice, const n
     return nt::OscillatorFrequency(animationScaler(shaped_lfo_value.get()));
 }
 
-DeepnoteVoice::State update_voice_state(const DeepnoteVoice &voice, const DeepnoteVoice::State current_state,
-                                        const nt::OscillatorFrequency current_frequency)
+template <size_t MaxOscillators>
+DeepnoteVoiceBase::State update_voice_state(const BasicDeepnoteVoice<MaxOscillators> &voice,
+                                            const DeepnoteVoiceBase::State             current_state,
+                                            const nt::OscillatorFrequency              current_frequency)
 {
 
     auto       state            = current_state;
@@ -337,7 +767,7 @@ DeepnoteVoice::State update_voice_state(const DeepnoteVoice &voice, const Deepno
     {
         //  The frequency is within the valid range, so check to see if we've
         //  reached the start or target frequency
-        if(state == DeepnoteVoice::IN_TRANSIT_TO_TARGET)
+        if(state == DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET)
         {
             const auto targetRange = nt::OscillatorFrequencyRange{
                 Range{nt::RangeLow(target_frequency.get() - constants::TARGET_FREQUENCY_TOLERANCE),
@@ -345,20 +775,22 @@ DeepnoteVoice::State update_voice_state(const DeepnoteVoice &voice, const Deepno
 
             if(targetRange.get().contains(current_frequency.get()))
             {
-                state = DeepnoteVoice::AT_TARGET;
+                state = DeepnoteVoiceBase::AT_TARGET;
             }
         }
     }
     else
     {
         // The frequency is outside the valid range, so constrain it
-        state = (state == DeepnoteVoice::IN_TRANSIT_TO_TARGET) ? DeepnoteVoice::AT_TARGET : state;
+        state = (state == DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET) ? DeepnoteVoiceBase::AT_TARGET : state;
     }
 
     return state;
 }
 
-nt::OscillatorFrequency constrain_frequency(const DeepnoteVoice &voice, const nt::OscillatorFrequency frequency)
+template <size_t MaxOscillators>
+nt::OscillatorFrequency constrain_frequency(const BasicDeepnoteVoice<MaxOscillators> &voice,
+                                            const nt::OscillatorFrequency             frequency)
 {
 
     const auto start_frequency  = voice.get_start_frequency();
@@ -373,6 +805,63 @@ nt::OscillatorFrequency constrain_frequency(const DeepnoteVoice &voice, const nt
 
     return nt::OscillatorFrequency(validFrequencyRange.get().constrain(frequency.get()));
 }
+
+//  One sample of a voice at target that hasn't yet settled into the steady state
+template <size_t MaxOscillators, typename TraceFunc>
+nt::OscillatorValue process_voice_at_target(BasicDeepnoteVoice<MaxOscillators> &voice,
+                                            const TraceFunc                    &trace_functor)
+{
+    const auto start_frequency  = voice.get_start_frequency();
+    const auto target_frequency = voice.get_target_frequency();
+
+    voice.set_current_frequency(target_frequency);
+    voice.set_state(DeepnoteVoiceBase::AT_TARGET);
+
+    nt::OscillatorValue osc_value = voice.process_oscillators();
+    voice.settle_at_target();
+
+    trace_functor(start_frequency.get(), target_frequency.get(), DeepnoteVoiceBase::AT_TARGET,
+                  DeepnoteVoiceBase::AT_TARGET, 0.0f, 0.0f, 0.0f, target_frequency.get(), osc_value.get());
+
+    return osc_value;
+}
+
+//  One sample of a voice in transit, or pending with its LFO already reset
+template <size_t MaxOscillators, typename TraceFunc>
+nt::OscillatorValue process_voice_in_transit(BasicDeepnoteVoice<MaxOscillators> &voice,
+                                             const DeepnoteVoiceBase::State in_state,
+                                             const nt::AnimationMultiplier lfo_multiplier, const nt::ControlPoint1 cp1,
+                                             const nt::ControlPoint2 cp2, const TraceFunc &trace_functor)
+{
+    const auto start_frequency  = voice.get_start_frequency();
+    const auto target_frequency = voice.get_target_frequency();
+
+    auto       current_frequency  = calculate_shaped_frequency(voice, lfo_multiplier, cp1, cp2);
+    const auto unconstrained_freq = current_frequency; // only used for tracing
+    const auto state = update_voice_state(voice, DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET, current_frequency);
+    current_frequency = constrain_frequency(voice, current_frequency);
+
+    // If we reached target after constraining, set exact target frequency
+    if(state == DeepnoteVoiceBase::AT_TARGET)
+    {
+        current_frequency = target_frequency;
+    }
+
+    voice.set_current_frequency(current_frequency);
+    voice.set_state(state);
+
+    //  Update all oscillators using the new frequency
+    nt::OscillatorValue osc_value = voice.process_oscillators();
+    voice.settle_at_target();
+
+    //  Give the traceFunctor a chance to log the state of the voice
+    trace_functor(start_frequency.get(), target_frequency.get(), in_state, state,
+                  0.0f, // raw_lfo_value - simplified for now
+                  0.0f, // shaped_lfo_value - simplified for now
+                  unconstrained_freq.get(), current_frequency.get(), osc_value.get());
+
+    return osc_value;
+}
 } // namespace
 
 /**
@@ -389,56 +878,60 @@ nt::OscillatorFrequency constrain_frequency(const DeepnoteVoice &voice, const nt
  * @param trace_functor Optional function for debugging/logging (default: no-op)
  * @return Combined oscillator output value
  */
-template <typename TraceFunc = NoopTrace>
-nt::OscillatorValue process_voice(DeepnoteVoice &voice, const nt::AnimationMultiplier lfo_multiplier,
-                                  const nt::ControlPoint1 cp1, const nt::ControlPoint2 cp2,
-                                  const TraceFunc &trace_functor = NoopTrace())
+template <size_t MaxOscillators, typename TraceFunc = NoopTrace>
+nt::OscillatorValue process_voice(BasicDeepnoteVoice<MaxOscillators> &voice,
+                                  const nt::AnimationMultiplier lfo_multiplier, const nt::ControlPoint1 cp1,
+                                  const nt::ControlPoint2 cp2, const TraceFunc &trace_functor = NoopTrace())
 {
-    nt::OscillatorFrequency unconstrained_freq(0.f); // only used for tracing
-    const auto              in_state{voice.get_state()};
-    auto                    state = in_state;
-
-    //  if we in a pending state, reset the animation LFO and move to the next state
-    if(state == DeepnoteVoice::PENDING_TRANSIT_TO_TARGET)
+    //  most voices spend most of their life at target, skip straight to the
+    //  oscillators when nothing has changed since the voice got there
+    if(voice.is_steady_state())
     {
-        voice.reset_lfo();
-        state = DeepnoteVoice::IN_TRANSIT_TO_TARGET;
+        const auto osc_value = voice.process_steady_oscillators();
+        trace_functor(voice.get_start_frequency().get(), voice.get_target_frequency().get(),
+                      DeepnoteVoiceBase::AT_TARGET, DeepnoteVoiceBase::AT_TARGET, 0.0f, 0.0f, 0.0f,
+                      voice.get_target_frequency().get(), osc_value.get());
+        return osc_value;
     }
 
-    const auto              start_frequency  = voice.get_start_frequency();
-    const auto              target_frequency = voice.get_target_frequency();
-    nt::OscillatorFrequency current_frequency(0.0f);
-
-    if(state == DeepnoteVoice::AT_TARGET)
+    const auto in_state{voice.get_state()};
+    if(in_state == DeepnoteVoiceBase::AT_TARGET)
     {
-        current_frequency = target_frequency;
+        return process_voice_at_target(voice, trace_functor);
     }
-    else
-    {
-        current_frequency  = calculate_shaped_frequency(voice, lfo_multiplier, cp1, cp2);
-        unconstrained_freq = current_frequency;
-        state              = update_voice_state(voice, state, current_frequency);
-        current_frequency  = constrain_frequency(voice, current_frequency);
 
-        // If we reached target after constraining, set exact target frequency
-        if(state == DeepnoteVoice::AT_TARGET)
-        {
-            current_frequency = target_frequency;
-        }
+    //  if we in a pending state, reset the animation LFO and move to the next state
+    if(in_state == DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET)
+    {
+        voice.reset_lfo();
     }
+    return process_voice_in_transit(voice, in_state, lfo_multiplier, cp1, cp2, trace_functor);
+}
 
-    voice.set_current_frequency(current_frequency);
-    voice.set_state(state);
-
-    //  Update all oscillators using the new frequency
-    nt::OscillatorValue osc_value = voice.process_oscillators();
-
-    //  Give the traceFunctor a chance to log the state of the voice
-    trace_functor(start_frequency.get(), target_frequency.get(), in_state, state,
-                  0.0f, // raw_lfo_value - simplified for now
-                  0.0f, // shaped_lfo_value - simplified for now
-                  unconstrained_freq.get(), current_frequency.get(), osc_value.get());
+/**
+ * @brief Process a block of audio samples from the voice
+ *
+ * Equivalent to calling process_voice() once per sample, with denormals
+ * flushed to zero for the duration of the block.
+ *
+ * @param voice Voice instance to process
+ * @param out Destination for count samples
+ * @param count Number of samples to render
+ * @param lfo_multiplier Speed multiplier for animation (1.0 = normal speed)
+ * @param cp1 First Bezier control point [0,1]
+ * @param cp2 Second Bezier control point [0,1]
+ * @param trace_functor Optional function for debugging/logging (default: no-op)
+ */
+template <size_t MaxOscillators, typename TraceFunc = NoopTrace>
+void process_voice_block(BasicDeepnoteVoice<MaxOscillators> &voice, float *out, const size_t count,
+                         const nt::AnimationMultiplier lfo_multiplier, const nt::ControlPoint1 cp1,
+                         const nt::ControlPoint2 cp2, const TraceFunc &trace_functor = NoopTrace())
+{
+    const ScopedFlushDenormals flush_denormals;
 
-    return osc_value;
+    for(size_t i = 0; i < count; ++i)
+    {
+        out[i] = process_voice(voice, lfo_multiplier, cp1, cp2, trace_functor).get();
+    }
 }
 } // namespace deepnote
@@ -0,0 +1,118 @@
+/**
+ * @file detune.hpp
+ * @brief Oscillator detune laws for the Deep Note synthesizer
+ *
+ * This file provides the spread laws that place a voice's oscillators either
+ * side of its fundamental, and the cents and ratio types used for detuning
+ * by a musical interval rather than a fixed number of Hz.
+ *
+ * @author David Irvine
+ * @date 2025
+ * @copyright MIT License
+ *
+ * Copyright (c) 2025 David Irvine
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "util/namedtype.hpp"
+#include <cmath>
+#include <cstddef>
+
+namespace deepnote
+{
+namespace constants
+{
+static constexpr float GOLDEN_RATIO = 1.6180339887f;
+} // namespace constants
+
+namespace nt
+{
+using DetuneCents = NamedType<float, struct DetuneCentsTag>;
+using DetuneRatio = NamedType<float, struct DetuneRatioTag>;
+} // namespace nt
+
+/**
+ * @brief How a voice's oscillators are spaced either side of the fundamental
+ *
+ * Each law gives oscillator i a signed number of detune steps. The outermost
+ * oscillators sit at the same number of steps under every law, so changing
+ * the law changes the spacing but not the overall width of the voice.
+ */
+enum DetuneSpread
+{
+    LINEAR_SPREAD,      //  ..., -2, -1, +1, +2, ... steps
+    EXPONENTIAL_SPREAD, //  each step out doubles, clustering oscillators near the fundamental
+    GOLDEN_SPREAD       //  each step out grows by the golden ratio, so no two spacings are simple multiples
+};
+
+/**
+ * @brief Signed number of detune steps for an oscillator
+ *
+ * For LINEAR_SPREAD this is the integer index the original Hz detune uses,
+ * so detuning by Hz with LINEAR_SPREAD is unchanged.
+ *
+ * @param spread Spread law
+ * @param index Oscillator index, 0 to count - 1
+ * @param count Number of oscillators in the voice
+ */
+inline float detune_step(const DetuneSpread spread, const size_t index, const size_t count) noexcept
+{
+    if(count <= 1)
+    {
+        return 0.f;
+    }
+
+    //  odd counts have one more step above the fundamental than below
+    const size_t half      = count / 2;
+    const bool   above     = index >= half;
+    const float  linear    = above ? static_cast<float>(index - half + 1) : -static_cast<float>(half - index);
+    const float  outermost = static_cast<float>(above ? count - half : half);
+    const float  sign      = above ? 1.f : -1.f;
+    switch(spread)
+    {
+    case EXPONENTIAL_SPREAD:
+        return sign * outermost * std::exp2(std::fabs(linear) - outermost);
+    case GOLDEN_SPREAD:
+        return sign * outermost * std::pow(constants::GOLDEN_RATIO, std::fabs(linear) - outermost);
+    case LINEAR_SPREAD:
+    default:
+        return linear;
+    }
+}
+
+/**
+ * @brief Frequency ratio of an interval in cents
+ */
+inline float cents_to_ratio(const float cents) noexcept
+{
+    return std::exp2(cents / 1200.f);
+}
+
+/**
+ * @brief Interval in cents of a frequency ratio
+ */
+inline float ratio_to_cents(const float ratio) noexcept
+{
+    return 1200.f * std::log2(ratio);
+}
+
+} // namespace deepnote
@@ -0,0 +1,247 @@
+/**
+ * @file transittiming.hpp
+ * @brief Transit timing predictions for the Deep Note synthesizer
+ *
+ * This file provides samples_until_target() and time_at_frequency(), which
+ * work out from a voice's LFO, control points and transit how long a transit
+ * will take, so hosts can plan retargets and voice culling without rendering
+ * ahead or polling voice state.
+ *
+ * @@LICENSE@@
+ */
+
+#pragma once
+
+#include "voice/deepnotevoice.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace deepnote
+{
+namespace constants
+{
+//  Returned by samples_until_target() for a transit that never reaches its target
+static constexpr uint64_t NEVER_AT_TARGET = UINT64_MAX;
+} // namespace constants
+
+namespace
+{
+inline double bezier_value(const double cp1, const double cp2, const double t) noexcept
+{
+    const double u = 1.0 - t;
+    return 3.0 * u * u * t * cp1 + 3.0 * u * t * t * cp2 + t * t * t;
+}
+
+/**
+ * @brief Earliest t in [0, 1] at which a condition on the Bezier curve holds
+ *
+ * The curve is split at its turning points into pieces on which it is
+ * monotonic, so a condition of the form value >= level or value < level
+ * changes at most once per piece and can be located by bisection.
+ *
+ * @return t, or a negative value if the condition never holds
+ */
+template <typename Condition>
+double first_bezier_time(const double cp1, const double cp2, const Condition &condition) noexcept
+{
+    //  B'(t) / 3 = a t^2 + b t + c
+    const double a = 3.0 * cp1 - 3.0 * cp2 + 1.0;
+    const double b = 2.0 * cp2 - 4.0 * cp1;
+    const double c = cp1;
+
+    double bounds[4] = {0.0, 1.0, 1.0, 1.0};
+    size_t count{1};
+    if(a == 0.0)
+    {
+        if(b != 0.0 && -c / b > 0.0 && -c / b < 1.0)
+        {
+            bounds[count++] = -c / b;
+        }
+    }
+    else
+    {
+        const double discriminant = b * b - 4.0 * a * c;
+        if(discriminant > 0.0)
+        {
+            const double root = std::sqrt(discriminant);
+            for(const double turn : {(-b - root) / (2.0 * a), (-b + root) / (2.0 * a)})
+            {
+                if(turn > 0.0 && turn < 1.0)
+                {
+                    bounds[count++] = turn;
+                }
+            }
+        }
+    }
+    bounds[count++] = 1.0;
+    std::sort(bounds, bounds + count);
+
+    for(size_t piece = 0; piece + 1 < count; ++piece)
+    {
+        double low  = bounds[piece];
+        double high = bounds[piece + 1];
+        if(condition(bezier_value(cp1, cp2, low)))
+        {
+            return low;
+        }
+        if(!condition(bezier_value(cp1, cp2, high)))
+        {
+            continue;
+        }
+        for(int i = 0; i < 64 && high - low > 0.0; ++i)
+        {
+            const double middle = 0.5 * (low + high);
+            (condition(bezier_value(cp1, cp2, middle)) ? high : low) = middle;
+        }
+        return high;
+    }
+    return -1.0;
+}
+
+/**
+ * @brief Number of LFO samples until its phase reaches a threshold
+ *
+ * Follows the float accumulation the LFO itself does rather than dividing,
+ * since with a small increment the rounding of each addition adds up: a ten
+ * minute transit at 48kHz ends about 90 seconds earlier than division says.
+ * Within a binade every addition rounds the same way, so the count is
+ * worked out a binade at a time.
+ *
+ * @param phase Phase the LFO will output next
+ * @param inc Phase increment per sample
+ * @param threshold Phase to reach, at most 1
+ */
+inline uint64_t lfo_samples_to_reach(float phase, const float inc, const double threshold) noexcept
+{
+    uint64_t samples{0};
+    while(phase < threshold)
+    {
+        const float next = phase + inc;
+        if(!(next > phase))
+        {
+            return constants::NEVER_AT_TARGET;
+        }
+        ++samples;
+        if(next >= threshold)
+        {
+            return samples;
+        }
+
+        //  every step from next stays the same size until the binade ends
+        const float step = (next + inc) - next;
+        int         exponent;
+        std::frexp(next, &exponent);
+        const double end   = std::min(std::ldexp(1.0, exponent), threshold);
+        const double steps = std::max(std::ceil((end - next) / step) - 1.0, 0.0);
+        phase              = static_cast<float>(next + steps * step);
+        samples += static_cast<uint64_t>(steps);
+    }
+    return samples;
+}
+} // namespace
+
+/**
+ * @brief Number of samples process_voice() renders before the voice is at target
+ *
+ * Finds where on the Bezier curve the voice first comes within
+ * TARGET_FREQUENCY_TOLERANCE of its target, or leaves the range between
+ * start and target, and how many samples the LFO takes to get there from
+ * its current position. Assumes the multiplier and control points stay as
+ * given for the rest of the transit. Agrees with rendering to within a
+ * sample; the difference comes from rounding in the render's own curve.
+ *
+ * @param voice Voice to query
+ * @param lfo_multiplier Speed multiplier the voice will be rendered with
+ * @param cp1 First Bezier control point the voice will be rendered with
+ * @param cp2 Second Bezier control point the voice will be rendered with
+ * @return Samples to render, 0 if already at target, constants::NEVER_AT_TARGET
+ *         if the LFO is stopped
+ */
+template <size_t MaxOscillators>
+uint64_t samples_until_target(const BasicDeepnoteVoice<MaxOscillators> &voice,
+                              const nt::AnimationMultiplier lfo_multiplier, const nt::ControlPoint1 cp1,
+                              const nt::ControlPoint2 cp2) noexcept
+{
+    if(voice.is_at_target())
+    {
+        return 0;
+    }
+
+    //  the shaped value at which the voice counts as arrived
+    const float  start       = voice.get_start_frequency().get();
+    const float  target      = voice.get_target_frequency().get();
+    const float  tolerance   = constants::TARGET_FREQUENCY_TOLERANCE;
+    const double arrival     = (std::abs(target - start) <= tolerance)
+                                   ? 0.0
+                                   : voice.transit_position(nt::OscillatorFrequency(
+                                         (target > start) ? target - tolerance : target + tolerance));
+    const double arrive_time = first_bezier_time(cp1.get(), cp2.get(), [arrival](const double value) {
+        return value >= arrival || value < 0.0;
+    });
+    if(arrive_time < 0.0)
+    {
+        return constants::NEVER_AT_TARGET;
+    }
+
+    //  a pending voice restarts its LFO on the next sample
+    float phase{0.f};
+    if(voice.get_state() == DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET)
+    {
+        phase = voice.get_lfo_position() + voice.get_lfo_phase_inc();
+        phase = (phase > 1.f) ? phase - 1.f : phase;
+    }
+
+    const uint64_t samples = lfo_samples_to_reach(phase, voice.lfo_phase_increment(lfo_multiplier), arrive_time);
+    return (samples == constants::NEVER_AT_TARGET) ? samples : samples + 1;
+}
+
+/**
+ * @brief Time from the start of a transit at which it passes a frequency
+ *
+ * Inverts the transit's frequency law and the Bezier curve analytically,
+ * then counts LFO samples to that point as samples_until_target() does, so
+ * time * sample rate is the index of the first sample of the transit at or
+ * past freq, to within a sample. Assumes the multiplier and control points
+ * stay as given.
+ *
+ * @param voice Voice whose transit to query
+ * @param freq Frequency to locate
+ * @param lfo_multiplier Speed multiplier the voice will be rendered with
+ * @param cp1 First Bezier control point the voice will be rendered with
+ * @param cp2 Second Bezier control point the voice will be rendered with
+ * @return Seconds from the first sample of the transit, or infinity if the
+ *         transit doesn't pass freq
+ */
+template <size_t MaxOscillators>
+float time_at_frequency(const BasicDeepnoteVoice<MaxOscillators> &voice, const nt::OscillatorFrequency freq,
+                        const nt::AnimationMultiplier lfo_multiplier, const nt::ControlPoint1 cp1,
+                        const nt::ControlPoint2 cp2) noexcept
+{
+    const float  never    = std::numeric_limits<float>::infinity();
+    const double position = voice.transit_position(freq);
+    if(position < 0.0 || position > 1.0)
+    {
+        return never;
+    }
+
+    const double time = first_bezier_time(cp1.get(), cp2.get(), [position](const double value) {
+        return value >= position;
+    });
+    if(time < 0.0)
+    {
+        return never;
+    }
+
+    const uint64_t samples = lfo_samples_to_reach(0.f, voice.lfo_phase_increment(lfo_multiplier), time);
+    if(samples == constants::NEVER_AT_TARGET)
+    {
+        return never;
+    }
+    //  a frequency at the start of the transit is passed on its first sample,
+    //  even with the LFO stopped
+    return (samples == 0) ? 0.f : static_cast<float>(samples * static_cast<double>(voice.get_lfo_sr_recip()));
+}
+
+} // namespace deepnote
@@ -0,0 +1,42 @@
+/**
+ * @file spectrum.hpp
+ * @brief Spectral measurements shared by the oscillator tests
+ *
+ * magnitude_at() measures a render at a single frequency, e.g. where an
+ * aliased partial lands, so tests can compare how much each oscillator
+ * kernel or table leaves there.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+namespace deepnote
+{
+namespace analysis
+{
+
+/**
+ * @brief Hann windowed single bin DFT magnitude
+ * @param signal Render to measure
+ * @param freq Frequency to measure at, in Hz
+ * @param sample_rate Sample rate of the render
+ */
+inline float magnitude_at(const std::vector<float> &signal, const float freq, const float sample_rate)
+{
+    const double two_pi = 6.283185307179586;
+    double       re{0.0};
+    double       im{0.0};
+    for(size_t n = 0; n < signal.size(); ++n)
+    {
+        const double window = 0.5 - 0.5 * std::cos(two_pi * n / (signal.size() - 1));
+        const double angle  = two_pi * freq * n / sample_rate;
+        re += signal[n] * window * std::cos(angle);
+        im -= signal[n] * window * std::sin(angle);
+    }
+    return static_cast<float>(std::sqrt(re * re + im * im));
+}
+
+} // namespace analysis
+} // namespace deepnote
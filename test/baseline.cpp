@@ -0,0 +1,136 @@
+#include "bench/baseline.hpp"
+#include <doctest/doctest.h>
+#include <sstream>
+
+using namespace deepnote::bench;
+
+namespace
+{
+
+std::vector<double> spread(const double centre, const size_t count)
+{
+    std::vector<double> values;
+    for(size_t i = 0; i < count; ++i)
+    {
+        values.push_back(centre * (1.0 + 0.01 * (static_cast<double>(i) - count / 2.0)));
+    }
+    return values;
+}
+
+} // namespace
+
+TEST_CASE("Benchmark baselines")
+{
+    SUBCASE("JSON round trip")
+    {
+        Baseline baseline;
+        baseline.machine    = MachineInfo{"host \"a\"", "CPU\\model", "gcc", "-O3 -march=native"};
+        baseline.benchmarks = {
+            {"voice/4osc", "ns/sample", {1.5, 2.25, 1e-3}, {{"cycles", 120.5}, {"llc_misses", 0.25}}},
+            {"empty", "ns/sample", {}, {}}};
+
+        std::stringstream json;
+        write_baseline(json, baseline);
+        const auto read = read_baseline(json);
+
+        CHECK(read.machine.hostname == baseline.machine.hostname);
+        CHECK(read.machine.cpu_model == baseline.machine.cpu_model);
+        CHECK(read.machine.flags == baseline.machine.flags);
+        REQUIRE(read.benchmarks.size() == 2);
+        CHECK(read.benchmarks[0].name == "voice/4osc");
+        CHECK(read.benchmarks[0].samples == baseline.benchmarks[0].samples);
+        CHECK(read.benchmarks[0].counters == baseline.benchmarks[0].counters);
+        CHECK(read.benchmarks[1].samples.empty());
+        CHECK(read.benchmarks[1].counters.empty());
+    }
+
+    SUBCASE("Malformed baselines are rejected")
+    {
+        for(const char *json : {"", "{\"machine\": 3}", "{\"benchmarks\": [{\"samples\": [1, x]}]}", "{\"other\": 1}"})
+        {
+            std::istringstream is(json);
+            CHECK_THROWS_AS(read_baseline(is), std::invalid_argument);
+        }
+    }
+
+    SUBCASE("Machine description")
+    {
+        const auto machine = describe_machine();
+        CHECK_FALSE(machine.hostname.empty());
+        CHECK_FALSE(machine.compiler.empty());
+        CHECK(same_configuration(machine, machine));
+    }
+
+    SUBCASE("Median")
+    {
+        CHECK(median({3.0, 1.0, 2.0}) == 2.0);
+        CHECK(median({4.0, 1.0, 2.0, 3.0}) == 2.5);
+        CHECK(median({}) == 0.0);
+    }
+
+    SUBCASE("Mann-Whitney U")
+    {
+        //  completely separated samples of 10 give p of about 0.0002
+        CHECK(mann_whitney_p_value(spread(100.0, 10), spread(120.0, 10)) < 0.001);
+        CHECK(mann_whitney_p_value(spread(100.0, 10), spread(100.0, 10)) > 0.9);
+        CHECK(mann_whitney_p_value({1.0, 1.0, 1.0}, {1.0, 1.0, 1.0}) == 1.0);
+        CHECK(mann_whitney_p_value({}, {1.0}) == 1.0);
+
+        //  symmetric in its arguments
+        const std::vector<double> a{1.0, 3.0, 5.0, 7.0, 9.0, 11.0, 13.0, 15.0};
+        const std::vector<double> b{2.0, 4.0, 6.0, 8.0, 30.0, 31.0, 32.0, 33.0};
+        CHECK(mann_whitney_p_value(a, b) == doctest::Approx(mann_whitney_p_value(b, a)));
+    }
+
+    SUBCASE("Verdicts need significance and size")
+    {
+        Baseline baseline;
+        baseline.benchmarks = {{"slower", "ns", spread(100.0, 15)},
+                               {"faster", "ns", spread(100.0, 15)},
+                               {"slightly_slower", "ns", spread(100.0, 15)},
+                               {"same", "ns", spread(100.0, 15)}};
+        Baseline current;
+        current.benchmarks = {{"slower", "ns", spread(120.0, 15)},
+                              {"faster", "ns", spread(80.0, 15)},
+                              {"slightly_slower", "ns", spread(102.0, 15)},
+                              {"same", "ns", spread(100.0, 15)},
+                              {"added", "ns", spread(50.0, 15)}};
+
+        const auto comparisons = compare_to_baseline(baseline, current, 5.0, 0.01);
+        REQUIRE(comparisons.size() == 5);
+        CHECK(comparisons[0].verdict == Comparison::REGRESSED);
+        CHECK(comparisons[0].change_percent == doctest::Approx(20.0));
+        CHECK(comparisons[1].verdict == Comparison::IMPROVED);
+        CHECK(comparisons[2].verdict == Comparison::UNCHANGED);
+        CHECK(comparisons[3].verdict == Comparison::UNCHANGED);
+        CHECK(comparisons[4].verdict == Comparison::NEW_BENCHMARK);
+        CHECK(has_regression(comparisons));
+        CHECK_FALSE(has_regression(compare_to_baseline(baseline, current, 25.0, 0.01)));
+
+        std::ostringstream table;
+        print_comparison(table, comparisons);
+        CHECK(table.str().find("REGRESSED") != std::string::npos);
+        CHECK(table.str().find("+20.00%") != std::string::npos);
+    }
+
+    SUBCASE("Counter comparison")
+    {
+        Baseline baseline;
+        baseline.benchmarks = {{"voice", "ns", {1.0}, {{"cycles", 100.0}, {"branch_misses", 0.5}, {"ipc", 2.0}}}};
+        Baseline current;
+        current.benchmarks = {{"voice", "ns", {1.0}, {{"cycles", 110.0}, {"ipc", 1.5}}},
+                              {"added", "ns", {1.0}, {{"cycles", 1.0}}}};
+
+        std::ostringstream table;
+        print_counter_comparison(table, baseline, current);
+        CHECK(table.str().find("+10.00%") != std::string::npos);
+        CHECK(table.str().find("ipc") != std::string::npos);
+        CHECK(table.str().find("-25.00%") != std::string::npos);
+        CHECK(table.str().find("branch_misses") == std::string::npos);
+        CHECK(table.str().find("added") == std::string::npos);
+
+        std::ostringstream none;
+        print_counter_comparison(none, baseline, Baseline{});
+        CHECK(none.str().empty());
+    }
+}
@@ -0,0 +1,614 @@
+/**
+ * @file baseline.hpp
+ * @brief Per-machine benchmark baselines and regression comparison
+ *
+ * A baseline is a JSON file holding the machine it was recorded on
+ * (hostname, CPU model, compiler and flags) and every repetition of every
+ * benchmark. New runs are compared against it with a two-sided Mann-Whitney
+ * U test, which doesn't assume timings are normally distributed, and a
+ * change only counts when it is both significant and larger than a
+ * threshold.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+#if !defined(DEEPNOTE_BENCH_FLAGS)
+#define DEEPNOTE_BENCH_FLAGS "unknown"
+#endif
+
+namespace deepnote
+{
+namespace bench
+{
+
+struct MachineInfo
+{
+    std::string hostname;
+    std::string cpu_model;
+    std::string compiler;
+    std::string flags;
+};
+
+struct BenchmarkSamples
+{
+    std::string         name;
+    std::string         unit;
+    std::vector<double> samples;
+    //  Median hardware counter values per unit and median "ipc", when counters were available
+    std::vector<std::pair<std::string, double>> counters;
+};
+
+struct Baseline
+{
+    MachineInfo                   machine;
+    std::vector<BenchmarkSamples> benchmarks;
+};
+
+inline std::string get_hostname()
+{
+#if defined(_WIN32)
+    const char *name = std::getenv("COMPUTERNAME");
+    return name != nullptr ? name : "unknown";
+#else
+    char name[256] = {};
+    return gethostname(name, sizeof(name) - 1) == 0 ? name : "unknown";
+#endif
+}
+
+inline std::string get_cpu_model()
+{
+#if defined(__APPLE__)
+    char   brand[256] = {};
+    size_t size       = sizeof(brand);
+    if(sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) == 0)
+    {
+        return brand;
+    }
+#else
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string   line;
+    while(std::getline(cpuinfo, line))
+    {
+        if(line.compare(0, 10, "model name") == 0 || line.compare(0, 8, "Hardware") == 0)
+        {
+            const auto colon = line.find(':');
+            if(colon != std::string::npos && colon + 2 <= line.size())
+            {
+                return line.substr(colon + 2);
+            }
+        }
+    }
+#endif
+    return "unknown";
+}
+
+inline std::string get_compiler()
+{
+#if defined(__clang__)
+    return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+inline MachineInfo describe_machine()
+{
+    return MachineInfo{get_hostname(), get_cpu_model(), get_compiler(), DEEPNOTE_BENCH_FLAGS};
+}
+
+inline bool same_configuration(const MachineInfo &a, const MachineInfo &b)
+{
+    return a.cpu_model == b.cpu_model && a.compiler == b.compiler && a.flags == b.flags;
+}
+
+//  JSON
+
+inline void write_json_string(std::ostream &os, const std::string &value)
+{
+    os << '"';
+    for(const char c : value)
+    {
+        if(c == '"' || c == '\\')
+        {
+            os << '\\' << c;
+        }
+        else if(static_cast<unsigned char>(c) < 0x20)
+        {
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec
+               << std::setfill(' ');
+        }
+        else
+        {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+inline void write_baseline(std::ostream &os, const Baseline &baseline)
+{
+    const auto precision = os.precision(17);
+
+    os << "{\n  \"machine\": {\n    \"hostname\": ";
+    write_json_string(os, baseline.machine.hostname);
+    os << ",\n    \"cpu_model\": ";
+    write_json_string(os, baseline.machine.cpu_model);
+    os << ",\n    \"compiler\": ";
+    write_json_string(os, baseline.machine.compiler);
+    os << ",\n    \"flags\": ";
+    write_json_string(os, baseline.machine.flags);
+    os << "\n  },\n  \"benchmarks\": [";
+    for(size_t b = 0; b < baseline.benchmarks.size(); ++b)
+    {
+        const auto &benchmark = baseline.benchmarks[b];
+        os << (b > 0 ? ",\n" : "\n") << "    {\"name\": ";
+        write_json_string(os, benchmark.name);
+        os << ", \"unit\": ";
+        write_json_string(os, benchmark.unit);
+        os << ", \"samples\": [";
+        for(size_t i = 0; i < benchmark.samples.size(); ++i)
+        {
+            os << (i > 0 ? ", " : "") << benchmark.samples[i];
+        }
+        os << "]";
+        if(!benchmark.counters.empty())
+        {
+            os << ", \"counters\": {";
+            for(size_t i = 0; i < benchmark.counters.size(); ++i)
+            {
+                os << (i > 0 ? ", " : "");
+                write_json_string(os, benchmark.counters[i].first);
+                os << ": " << benchmark.counters[i].second;
+            }
+            os << "}";
+        }
+        os << "}";
+    }
+    os << "\n  ]\n}\n";
+
+    os.precision(precision);
+}
+
+/**
+ * @brief Reads the subset of JSON that write_baseline() produces
+ */
+struct BaselineReader
+{
+    explicit BaselineReader(std::istream &is)
+        : text(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>())
+    {
+    }
+
+    Baseline read()
+    {
+        Baseline baseline;
+        read_object([&](const std::string &key) {
+            if(key == "machine")
+            {
+                read_object([&](const std::string &field) {
+                    if(field == "hostname")
+                    {
+                        baseline.machine.hostname = read_string();
+                    }
+                    else if(field == "cpu_model")
+                    {
+                        baseline.machine.cpu_model = read_string();
+                    }
+                    else if(field == "compiler")
+                    {
+                        baseline.machine.compiler = read_string();
+                    }
+                    else if(field == "flags")
+                    {
+                        baseline.machine.flags = read_string();
+                    }
+                    else
+                    {
+                        fail("unknown machine field " + field);
+                    }
+                });
+            }
+            else if(key == "benchmarks")
+            {
+                read_array([&]() {
+                    BenchmarkSamples benchmark;
+                    read_object([&](const std::string &field) {
+                        if(field == "name")
+                        {
+                            benchmark.name = read_string();
+                        }
+                        else if(field == "unit")
+                        {
+                            benchmark.unit = read_string();
+                        }
+                        else if(field == "samples")
+                        {
+                            read_array([&]() { benchmark.samples.push_back(read_number()); });
+                        }
+                        else if(field == "counters")
+                        {
+                            read_object([&](const std::string &counter) {
+                                benchmark.counters.emplace_back(counter, read_number());
+                            });
+                        }
+                        else
+                        {
+                            fail("unknown benchmark field " + field);
+                        }
+                    });
+                    baseline.benchmarks.push_back(std::move(benchmark));
+                });
+            }
+            else
+            {
+                fail("unknown field " + key);
+            }
+        });
+        return baseline;
+    }
+
+  private:
+    [[noreturn]] void fail(const std::string &what) const
+    {
+        throw std::invalid_argument("Malformed baseline at offset " + std::to_string(position) + ": " + what);
+    }
+
+    void skip_space()
+    {
+        while(position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+        {
+            ++position;
+        }
+    }
+
+    void expect(const char c)
+    {
+        skip_space();
+        if(position >= text.size() || text[position] != c)
+        {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++position;
+    }
+
+    bool accept(const char c)
+    {
+        skip_space();
+        if(position < text.size() && text[position] == c)
+        {
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    template <typename Member> void read_object(Member &&member)
+    {
+        expect('{');
+        if(accept('}'))
+        {
+            return;
+        }
+        do
+        {
+            const std::string key = read_string();
+            expect(':');
+            member(key);
+        } while(accept(','));
+        expect('}');
+    }
+
+    template <typename Element> void read_array(Element &&element)
+    {
+        expect('[');
+        if(accept(']'))
+        {
+            return;
+        }
+        do
+        {
+            element();
+        } while(accept(','));
+        expect(']');
+    }
+
+    std::string read_string()
+    {
+        expect('"');
+        std::string value;
+        while(position < text.size() && text[position] != '"')
+        {
+            char c = text[position++];
+            if(c == '\\')
+            {
+                if(position >= text.size())
+                {
+                    fail("unterminated escape");
+                }
+                c = text[position++];
+                if(c == 'u')
+                {
+                    if(position + 4 > text.size())
+                    {
+                        fail("short \\u escape");
+                    }
+                    c = static_cast<char>(std::stoi(text.substr(position, 4), nullptr, 16));
+                    position += 4;
+                }
+                else if(c == 'n')
+                {
+                    c = '\n';
+                }
+                else if(c == 't')
+                {
+                    c = '\t';
+                }
+            }
+            value += c;
+        }
+        expect('"');
+        return value;
+    }
+
+    double read_number()
+    {
+        skip_space();
+        const char *begin = text.c_str() + position;
+        char       *end   = nullptr;
+        const double value = std::strtod(begin, &end);
+        if(end == begin)
+        {
+            fail("expected a number");
+        }
+        position += static_cast<size_t>(end - begin);
+        return value;
+    }
+
+    std::string text;
+    size_t      position{0};
+};
+
+inline Baseline read_baseline(std::istream &is)
+{
+    return BaselineReader(is).read();
+}
+
+//  Statistics
+
+inline double median(std::vector<double> values)
+{
+    if(values.empty())
+    {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return values.size() % 2 == 1 ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+}
+
+/**
+ * @brief Two-sided p-value of the Mann-Whitney U test
+ *
+ * Uses the normal approximation with a tie correction, which is accurate
+ * from around 8 samples per side.
+ */
+inline double mann_whitney_p_value(const std::vector<double> &a, const std::vector<double> &b)
+{
+    const size_t n1 = a.size();
+    const size_t n2 = b.size();
+    if(n1 == 0 || n2 == 0)
+    {
+        return 1.0;
+    }
+
+    std::vector<std::pair<double, size_t>> pooled;
+    for(const double v : a)
+    {
+        pooled.emplace_back(v, 0);
+    }
+    for(const double v : b)
+    {
+        pooled.emplace_back(v, 1);
+    }
+    std::sort(pooled.begin(), pooled.end());
+
+    //  average ranks across ties
+    double rank_sum_a{0.0};
+    double tie_term{0.0};
+    for(size_t i = 0; i < pooled.size();)
+    {
+        size_t j = i;
+        while(j < pooled.size() && pooled[j].first == pooled[i].first)
+        {
+            ++j;
+        }
+        const double rank = 0.5 * (i + 1 + j);
+        const double ties = static_cast<double>(j - i);
+        for(size_t k = i; k < j; ++k)
+        {
+            rank_sum_a += pooled[k].second == 0 ? rank : 0.0;
+        }
+        tie_term += ties * ties * ties - ties;
+        i = j;
+    }
+
+    const double n        = static_cast<double>(n1 + n2);
+    const double u        = rank_sum_a - n1 * (n1 + 1) / 2.0;
+    const double mean     = n1 * n2 / 2.0;
+    const double variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)));
+    if(variance <= 0.0)
+    {
+        return 1.0;
+    }
+
+    //  continuity correction
+    const double z = std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+//  Comparison
+
+struct Comparison
+{
+    enum Verdict
+    {
+        UNCHANGED,
+        IMPROVED,
+        REGRESSED,
+        NEW_BENCHMARK
+    };
+
+    std::string name;
+    std::string unit;
+    double      baseline_median;
+    double      current_median;
+    double      change_percent;
+    double      p_value;
+    Verdict     verdict;
+};
+
+/**
+ * @brief Compare a run against a baseline
+ *
+ * Lower is better. A benchmark has improved or regressed when its median
+ * moved by more than threshold_percent and the difference is significant at
+ * alpha; otherwise it is unchanged.
+ */
+inline std::vector<Comparison> compare_to_baseline(const Baseline &baseline, const Baseline &current,
+                                                   const double threshold_percent, const double alpha)
+{
+    std::vector<Comparison> comparisons;
+    for(const auto &benchmark : current.benchmarks)
+    {
+        const auto previous = std::find_if(baseline.benchmarks.begin(), baseline.benchmarks.end(),
+                                           [&](const BenchmarkSamples &b) { return b.name == benchmark.name; });
+        const double current_median = median(benchmark.samples);
+        if(previous == baseline.benchmarks.end())
+        {
+            comparisons.push_back(Comparison{benchmark.name, benchmark.unit, 0.0, current_median, 0.0, 1.0,
+                                             Comparison::NEW_BENCHMARK});
+            continue;
+        }
+
+        const double baseline_median = median(previous->samples);
+        const double change = baseline_median > 0.0 ? 100.0 * (current_median - baseline_median) / baseline_median
+                                                    : 0.0;
+        const double p_value = mann_whitney_p_value(previous->samples, benchmark.samples);
+
+        auto verdict = Comparison::UNCHANGED;
+        if(p_value < alpha && change > threshold_percent)
+        {
+            verdict = Comparison::REGRESSED;
+        }
+        else if(p_value < alpha && change < -threshold_percent)
+        {
+            verdict = Comparison::IMPROVED;
+        }
+        comparisons.push_back(
+            Comparison{benchmark.name, benchmark.unit, baseline_median, current_median, change, p_value, verdict});
+    }
+    return comparisons;
+}
+
+inline bool has_regression(const std::vector<Comparison> &comparisons)
+{
+    return std::any_of(comparisons.begin(), comparisons.end(),
+                       [](const Comparison &c) { return c.verdict == Comparison::REGRESSED; });
+}
+
+inline void print_comparison(std::ostream &os, const std::vector<Comparison> &comparisons)
+{
+    static const char *const verdicts[] = {"unchanged", "IMPROVED", "REGRESSED", "new"};
+
+    size_t width = 9;
+    for(const auto &c : comparisons)
+    {
+        width = std::max(width, c.name.size());
+    }
+
+    std::ostringstream table;
+    table << std::fixed << std::left << std::setw(width + 2) << "benchmark" << std::right << std::setw(12)
+          << "baseline" << std::setw(12) << "current" << std::setw(10) << "change" << std::setw(10) << "p"
+          << "  verdict\n";
+    for(const auto &c : comparisons)
+    {
+        table << std::left << std::setw(width + 2) << c.name << std::right << std::setprecision(2) << std::setw(12)
+              << c.baseline_median << std::setw(12) << c.current_median << std::setw(9) << std::showpos
+              << c.change_percent << std::noshowpos << "%" << std::setprecision(4) << std::setw(10) << c.p_value
+              << "  " << verdicts[c.verdict] << "\n";
+    }
+    os << table.str();
+}
+
+/**
+ * @brief Print how each benchmark's hardware counters moved against the baseline
+ *
+ * Only benchmarks with counters in both runs are listed, which shows whether
+ * a timing change comes from executing more instructions, cache misses or
+ * branch mispredictions.
+ */
+inline void print_counter_comparison(std::ostream &os, const Baseline &baseline, const Baseline &current)
+{
+    std::ostringstream table;
+    table << std::fixed << std::setprecision(2);
+    for(const auto &benchmark : current.benchmarks)
+    {
+        const auto previous = std::find_if(baseline.benchmarks.begin(), baseline.benchmarks.end(),
+                                           [&](const BenchmarkSamples &b) { return b.name == benchmark.name; });
+        if(previous == baseline.benchmarks.end())
+        {
+            continue;
+        }
+        for(const auto &counter : benchmark.counters)
+        {
+            const auto before = std::find_if(previous->counters.begin(), previous->counters.end(),
+                                             [&](const std::pair<std::string, double> &c) {
+                                                 return c.first == counter.first;
+                                             });
+            if(before == previous->counters.end())
+            {
+                continue;
+            }
+            const double change = before->second > 0.0 ? 100.0 * (counter.second - before->second) / before->second
+                                                       : 0.0;
+            table << std::left << std::setw(32) << benchmark.name << std::setw(16) << counter.first << std::right
+                  << std::setw(12) << before->second << std::setw(12) << counter.second << std::setw(9)
+                  << std::showpos << change << std::noshowpos << "%\n";
+        }
+    }
+    if(!table.str().empty())
+    {
+        os << std::left << std::setw(32) << "benchmark" << std::setw(16) << "counter" << std::right << std::setw(12)
+           << "baseline" << std::setw(12) << "current" << std::setw(10) << "change" << "\n"
+           << table.str();
+    }
+}
+
+} // namespace bench
+} // namespace deepnote
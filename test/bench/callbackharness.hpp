@@ -0,0 +1,126 @@
+/**
+ * @file callbackharness.hpp
+ * @brief Simulated real-time audio callback for benchmarks
+ *
+ * Drives a render function the way an audio device would: one block every
+ * block_size / sample_rate seconds, each of which must be ready before the
+ * device needs it. No audio hardware is involved; the device is modelled on
+ * the steady clock.
+ */
+
+#pragma once
+
+#include "latencyhistogram.hpp"
+#include <chrono>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace deepnote
+{
+namespace bench
+{
+
+struct CallbackHarnessConfig
+{
+    size_t block_size{64};
+    float  sample_rate{48000.f};
+    size_t callbacks{750};
+    //  Wait for each callback's slot, as a device would. When false, callbacks
+    //  run back to back and each is judged against the deadline on its own.
+    bool paced{true};
+};
+
+struct CallbackReport
+{
+    size_t           callbacks{0};
+    size_t           xruns{0};
+    size_t           late_wakeups{0};
+    double           deadline_ns{0.0};
+    LatencyHistogram compute_ns;
+
+    double get_mean_load() const noexcept { return 100.0 * compute_ns.get_mean() / deadline_ns; }
+    double get_load(const double percent) const noexcept
+    {
+        return 100.0 * compute_ns.percentile(percent) / deadline_ns;
+    }
+    double get_peak_load() const noexcept { return 100.0 * compute_ns.get_max() / deadline_ns; }
+};
+
+/**
+ * @brief Run a render function as a simulated audio callback
+ *
+ * The device requests block n at start + n * period and plays it one period
+ * later. A callback whose compute time exceeds the period is an xrun, and the
+ * schedule restarts from the end of that callback, as drivers do after an
+ * underrun, so one spike isn't counted as a run of xruns. When paced, a
+ * callback that misses its slot only because the harness thread woke late is
+ * counted in late_wakeups instead, since that measures the host scheduler
+ * rather than the render.
+ *
+ * @param config Block size, sample rate, callback count and pacing
+ * @param render Called as render(float *out, size_t count) once per callback
+ * @return Compute time per callback, xruns and load against the deadline
+ */
+template <typename Render> CallbackReport run_callback_harness(const CallbackHarnessConfig &config, Render &&render)
+{
+    if(config.block_size == 0 || config.sample_rate <= 0.f)
+    {
+        throw std::invalid_argument("Callback harness needs a block size and sample rate");
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    CallbackReport report;
+    report.deadline_ns = 1e9 * config.block_size / config.sample_rate;
+    const auto period  = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::nano>(
+        report.deadline_ns));
+
+    std::vector<float> out(config.block_size);
+    auto               slot = Clock::now();
+    for(size_t n = 0; n < config.callbacks; ++n)
+    {
+        if(config.paced)
+        {
+            std::this_thread::sleep_until(slot);
+        }
+
+        const auto begin = Clock::now();
+        render(out.data(), out.size());
+        const auto end = Clock::now();
+
+        const auto compute = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+        report.compute_ns.record(static_cast<uint64_t>(compute));
+        ++report.callbacks;
+
+        if(end - begin > period)
+        {
+            ++report.xruns;
+            slot = end;
+        }
+        else if(config.paced && end > slot + period)
+        {
+            ++report.late_wakeups;
+            slot = end;
+        }
+        else
+        {
+            slot += period;
+        }
+    }
+    return report;
+}
+
+inline std::ostream &operator<<(std::ostream &os, const CallbackReport &report)
+{
+    os << report.callbacks << " callbacks, " << report.xruns << " xruns, " << report.late_wakeups
+       << " late wakeups, deadline " << report.deadline_ns / 1000.0 << "us\n";
+    os << "load mean " << report.get_mean_load() << "%, p99 " << report.get_load(99.0) << "%, p99.9 "
+       << report.get_load(99.9) << "%, max " << report.get_peak_load() << "%\n";
+    print_histogram(os, report.compute_ns, "ns");
+    return os;
+}
+
+} // namespace bench
+} // namespace deepnote
@@ -0,0 +1,80 @@
+/**
+ * @file cyclecounter.hpp
+ * @brief Low-overhead timestamp counter for per-call latency measurement
+ *
+ * Reads the TSC on x86 and the virtual counter on AArch64. Elsewhere it
+ * falls back to the steady clock in nanoseconds. cycle_counter_unit() names
+ * what the values count.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define DEEPNOTE_CYCLE_COUNTER_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DEEPNOTE_CYCLE_COUNTER_TSC
+#endif
+
+namespace deepnote
+{
+namespace bench
+{
+
+/**
+ * @brief Read the counter, ordered against surrounding instructions
+ */
+inline uint64_t read_cycle_counter() noexcept
+{
+#if defined(DEEPNOTE_CYCLE_COUNTER_TSC)
+    _mm_lfence();
+    const uint64_t cycles = __rdtsc();
+    _mm_lfence();
+    return cycles;
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+#endif
+}
+
+inline const char *cycle_counter_unit() noexcept
+{
+#if defined(DEEPNOTE_CYCLE_COUNTER_TSC)
+    return "cycles";
+#elif defined(__aarch64__)
+    return "ticks";
+#else
+    return "ns";
+#endif
+}
+
+/**
+ * @brief Smallest difference between two back-to-back reads
+ *
+ * Subtract this from measured intervals so short calls aren't dominated by
+ * the cost of reading the counter.
+ */
+inline uint64_t cycle_counter_overhead() noexcept
+{
+    uint64_t overhead{UINT64_MAX};
+    for(int i = 0; i < 1000; ++i)
+    {
+        const uint64_t begin = read_cycle_counter();
+        const uint64_t end   = read_cycle_counter();
+        overhead             = std::min(overhead, end - begin);
+    }
+    return overhead;
+}
+
+} // namespace bench
+} // namespace deepnote
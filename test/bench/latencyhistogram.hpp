@@ -0,0 +1,185 @@
+/**
+ * @file latencyhistogram.hpp
+ * @brief Log-linear latency histogram for benchmarks
+ *
+ * Values below 128 are counted exactly. Above that, each power of two is
+ * split into 64 buckets, so any recorded value is reported to within 1.6%
+ * across the whole uint64_t range in a fixed 30KB of counters.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+namespace deepnote
+{
+namespace bench
+{
+
+struct LatencyHistogram
+{
+    static constexpr size_t SUB_BUCKETS  = 64;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS * 59;
+
+    void record(const uint64_t value) noexcept
+    {
+        ++buckets[bucket_index(value)];
+        ++count;
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    void merge(const LatencyHistogram &other) noexcept
+    {
+        for(size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    void reset() noexcept { *this = LatencyHistogram(); }
+
+    uint64_t get_count() const noexcept { return count; }
+    uint64_t get_min() const noexcept { return count > 0 ? min : 0; }
+    uint64_t get_max() const noexcept { return max; }
+    double   get_mean() const noexcept { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+
+    /**
+     * @brief Smallest value that at least percent% of recorded values don't exceed
+     *
+     * Reported as the upper edge of the bucket holding it, never above the
+     * largest value recorded, so tail percentiles err on the pessimistic side.
+     *
+     * @param percent Percentile in [0, 100]
+     */
+    uint64_t percentile(const double percent) const noexcept
+    {
+        if(count == 0)
+        {
+            return 0;
+        }
+
+        const double rank = std::max(1.0, percent / 100.0 * count);
+        uint64_t     seen{0};
+        for(size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            seen += buckets[i];
+            if(seen >= rank)
+            {
+                return std::min(bucket_upper(i), max);
+            }
+        }
+        return max;
+    }
+
+    /**
+     * @brief Visit the non-empty buckets in ascending order
+     * @param visitor Called as visitor(lower, upper, count) with inclusive bounds
+     */
+    template <typename Visitor> void for_each_bucket(Visitor &&visitor) const
+    {
+        for(size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            if(buckets[i] > 0)
+            {
+                visitor(bucket_lower(i), bucket_upper(i), buckets[i]);
+            }
+        }
+    }
+
+    static size_t bucket_index(const uint64_t value) noexcept
+    {
+        if(value < 2 * SUB_BUCKETS)
+        {
+            return static_cast<size_t>(value);
+        }
+        const size_t shift = 63 - count_leading_zeros(value) - 6;
+        return SUB_BUCKETS * shift + static_cast<size_t>(value >> shift);
+    }
+
+    static uint64_t bucket_lower(const size_t index) noexcept
+    {
+        if(index < 2 * SUB_BUCKETS)
+        {
+            return index;
+        }
+        const size_t shift = index / SUB_BUCKETS - 1;
+        return static_cast<uint64_t>(index - SUB_BUCKETS * shift) << shift;
+    }
+
+    static uint64_t bucket_upper(const size_t index) noexcept
+    {
+        if(index < 2 * SUB_BUCKETS)
+        {
+            return index;
+        }
+        const size_t shift = index / SUB_BUCKETS - 1;
+        return ((static_cast<uint64_t>(index - SUB_BUCKETS * shift) + 1) << shift) - 1;
+    }
+
+  private:
+    static size_t count_leading_zeros(const uint64_t value) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_clzll(value));
+#else
+        size_t zeros{0};
+        for(uint64_t bit = uint64_t(1) << 63; (value & bit) == 0; bit >>= 1)
+        {
+            ++zeros;
+        }
+        return zeros;
+#endif
+    }
+
+    std::array<uint64_t, BUCKET_COUNT> buckets{};
+    uint64_t                           count{0};
+    uint64_t                           sum{0};
+    uint64_t                           min{UINT64_MAX};
+    uint64_t                           max{0};
+};
+
+/**
+ * @brief Print a histogram with one row per power of two
+ * @param os Destination
+ * @param histogram Values to print
+ * @param unit Suffix for the values, e.g. "ns" or "cycles"
+ */
+inline void print_histogram(std::ostream &os, const LatencyHistogram &histogram, const char *unit)
+{
+    std::array<uint64_t, 65> rows{};
+    histogram.for_each_bucket([&](const uint64_t lower, const uint64_t, const uint64_t count) {
+        size_t row{0};
+        for(uint64_t v = lower; v > 0; v >>= 1)
+        {
+            ++row;
+        }
+        rows[row] += count;
+    });
+
+    const uint64_t widest = *std::max_element(rows.begin(), rows.end());
+    for(size_t row = 0; row < rows.size(); ++row)
+    {
+        if(rows[row] == 0)
+        {
+            continue;
+        }
+        const uint64_t lower = row == 0 ? 0 : uint64_t(1) << (row - 1);
+        const size_t   width = static_cast<size_t>(40 * rows[row] / widest);
+        os << std::setw(12) << lower << " " << unit << " " << std::setw(10) << rows[row] << " "
+           << std::string(std::max<size_t>(width, 1), '#') << "\n";
+    }
+}
+
+} // namespace bench
+} // namespace deepnote
@@ -0,0 +1,185 @@
+/**
+ * @file perfcounters.hpp
+ * @brief Hardware performance counters for benchmarks via perf_event_open
+ *
+ * Counts user-space cycles, instructions, L1 data cache read misses, last
+ * level cache misses and branch mispredictions for the calling thread on
+ * Linux. Each counter is opened on its own, so a PMU that lacks one event
+ * still reports the rest. On other platforms, or where the kernel refuses
+ * (perf_event_paranoid, containers, VMs without a virtual PMU), nothing is
+ * counted and get_unavailable_reason() says why.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace deepnote
+{
+namespace bench
+{
+
+struct CounterValues
+{
+    enum Counter
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        COUNTER_COUNT
+    };
+
+    //  Scaled for multiplexing; zero for counters that aren't valid
+    std::array<double, COUNTER_COUNT> values{};
+    std::array<bool, COUNTER_COUNT>   valid{};
+
+    bool   has(const Counter counter) const noexcept { return valid[counter]; }
+    double get(const Counter counter) const noexcept { return values[counter]; }
+
+    double get_ipc() const noexcept
+    {
+        return has(CYCLES) && has(INSTRUCTIONS) && values[CYCLES] > 0.0 ? values[INSTRUCTIONS] / values[CYCLES]
+                                                                        : 0.0;
+    }
+
+    static const char *name(const Counter counter) noexcept
+    {
+        static const char *const names[] = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+        return names[counter];
+    }
+};
+
+struct PerfCounters
+{
+    PerfCounters()
+    {
+        descriptors.fill(-1);
+#if defined(__linux__)
+        const std::array<std::pair<uint32_t, uint64_t>, CounterValues::COUNTER_COUNT> events = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        }};
+
+        int error{0};
+        for(size_t i = 0; i < events.size(); ++i)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size           = sizeof(attr);
+            attr.type           = events[i].first;
+            attr.config         = events[i].second;
+            attr.disabled       = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            descriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if(descriptors[i] < 0)
+            {
+                error = errno;
+            }
+        }
+        if(!is_available())
+        {
+            unavailable_reason = std::string("perf_event_open failed: ") + std::strerror(error);
+        }
+#else
+        unavailable_reason = "hardware counters need Linux perf_event_open";
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#if defined(__linux__)
+        for(const int fd : descriptors)
+        {
+            if(fd >= 0)
+            {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters &other)            = delete;
+    PerfCounters &operator=(const PerfCounters &other) = delete;
+
+    //  True if at least one counter could be opened
+    bool is_available() const noexcept
+    {
+        for(const int fd : descriptors)
+        {
+            if(fd >= 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const std::string &get_unavailable_reason() const noexcept { return unavailable_reason; }
+
+    void start() noexcept
+    {
+#if defined(__linux__)
+        for(const int fd : descriptors)
+        {
+            if(fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    CounterValues stop() noexcept
+    {
+        CounterValues result;
+#if defined(__linux__)
+        for(const int fd : descriptors)
+        {
+            if(fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for(size_t i = 0; i < descriptors.size(); ++i)
+        {
+            //  value, time enabled, time running
+            uint64_t data[3] = {};
+            if(descriptors[i] < 0 || read(descriptors[i], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+            {
+                continue;
+            }
+            result.values[i] = static_cast<double>(data[0]) * data[1] / data[2];
+            result.valid[i]  = true;
+        }
+#endif
+        return result;
+    }
+
+  private:
+    std::array<int, CounterValues::COUNTER_COUNT> descriptors;
+    std::string                                   unavailable_reason;
+};
+
+} // namespace bench
+} // namespace deepnote
@@ -0,0 +1,427 @@
+/**
+ * @file runner.cpp
+ * @brief Benchmark runner with per-machine baselines
+ *
+ * Usage: bench [--record] [--baseline FILE] [--threshold PERCENT] [--alpha P]
+ *              [--repetitions N] [--filter TEXT] [--footprint]
+ *
+ * On Linux, cycles, instructions, L1D and LLC misses and branch mispredictions
+ * are counted per sample alongside the timing when perf_event_open allows it,
+ * and instructions per cycle is reported as "ipc".
+ *
+ * --record writes the run to the baseline file, by default
+ * bench-baseline-<hostname>.json. Otherwise the run is compared against the
+ * baseline and the exit status is 1 if any benchmark regressed by more than
+ * the threshold (default 5%) at significance alpha (default 0.01).
+ *
+ * --footprint prints the memory footprint of common voice and ensemble
+ * configurations, and how many voices fit in Daisy SRAM and L2, then exits.
+ */
+
+#include "baseline.hpp"
+#include "perfcounters.hpp"
+#include "ensemble/ensemble.hpp"
+#include "ensemble/footprint.hpp"
+#include "ensemble/mixbus.hpp"
+#include "fixedpoint/fixedvoice.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace deepnote;
+
+namespace
+{
+
+constexpr float SAMPLE_RATE = 48000.f;
+
+//  Keeps results observable so the optimiser can't drop the work
+volatile float sink;
+
+//  Times the work and, where available, counts it with the hardware counters
+struct Stopwatch
+{
+    explicit Stopwatch(bench::PerfCounters &counters)
+        : counters(counters)
+    {
+    }
+
+    void start()
+    {
+        counters.start();
+        begin = std::chrono::steady_clock::now();
+    }
+
+    void stop()
+    {
+        const auto end = std::chrono::steady_clock::now();
+        values         = counters.stop();
+        elapsed_ns     = std::chrono::duration<double, std::nano>(end - begin).count();
+    }
+
+    bench::PerfCounters                  &counters;
+    std::chrono::steady_clock::time_point begin;
+    double                                elapsed_ns{0.0};
+    bench::CounterValues                  values;
+};
+
+//  Each benchmark sets up fresh state, times its work with the stopwatch and
+//  returns the number of voice samples rendered
+struct Benchmark
+{
+    const char *name;
+    size_t (*run)(Stopwatch &stopwatch);
+};
+
+template <typename Voice> void init_transit(Voice &voice, const size_t oscillators, const float start)
+{
+    init_voice(voice, oscillators, nt::OscillatorFrequency(start), nt::SampleRate(SAMPLE_RATE),
+               nt::OscillatorFrequency(1.f), nt::DetuneHz(2.5f));
+    voice.set_target_frequency(nt::OscillatorFrequency(start * 4.f));
+}
+
+template <size_t Oscillators, bool Settled> size_t run_voice(Stopwatch &stopwatch)
+{
+    DeepnoteVoice voice;
+    init_transit(voice, Oscillators, 220.f);
+    while(Settled && !voice.is_at_target())
+    {
+        process_voice(voice, nt::AnimationMultiplier(4.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+    }
+
+    const size_t samples = 24000;
+    float        sum{0.f};
+    stopwatch.start();
+    for(size_t i = 0; i < samples; ++i)
+    {
+        sum += process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f))
+                   .get();
+    }
+    stopwatch.stop();
+    sink = sum;
+    return samples;
+}
+
+size_t run_oscillators(Stopwatch &stopwatch)
+{
+    DeepnoteVoice voice;
+    init_transit(voice, 16, 220.f);
+
+    const size_t samples = 24000;
+    float        sum{0.f};
+    stopwatch.start();
+    for(size_t i = 0; i < samples; ++i)
+    {
+        sum += voice.process_oscillators().get();
+    }
+    stopwatch.stop();
+    sink = sum;
+    return samples;
+}
+
+size_t run_voice_block(Stopwatch &stopwatch)
+{
+    DeepnoteVoice voice;
+    init_transit(voice, 8, 110.f);
+
+    std::array<float, 64> out;
+    const size_t          blocks = 375;
+    stopwatch.start();
+    for(size_t b = 0; b < blocks; ++b)
+    {
+        process_voice_block(voice, out.data(), out.size(), nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f),
+                            nt::ControlPoint2(0.5f));
+    }
+    stopwatch.stop();
+    sink = out[0];
+    return blocks * out.size();
+}
+
+size_t run_ensemble(Stopwatch &stopwatch)
+{
+    std::vector<DeepnoteVoice> voices(32);
+    for(size_t i = 0; i < voices.size(); ++i)
+    {
+        init_transit(voices[i], 4, 40.f + 10.f * i);
+    }
+
+    std::array<float, 64> out;
+    const size_t          blocks = 75;
+    stopwatch.start();
+    for(size_t b = 0; b < blocks; ++b)
+    {
+        process_ensemble_block(voices.begin(), voices.end(), out.data(), out.size(), nt::AnimationMultiplier(1.f),
+                               nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+    }
+    stopwatch.stop();
+    sink = out[0];
+    return blocks * out.size() * voices.size();
+}
+
+size_t run_ensemble_stereo(Stopwatch &stopwatch)
+{
+    std::vector<DeepnoteVoice> voices(32);
+    MixBus<32>                 bus;
+    for(size_t i = 0; i < voices.size(); ++i)
+    {
+        init_transit(voices[i], 4, 40.f + 10.f * i);
+        bus.set_pan(i, -1.f + 2.f * i / 31.f);
+    }
+
+    std::array<float, 64> left;
+    std::array<float, 64> right;
+    const size_t          blocks = 75;
+    stopwatch.start();
+    for(size_t b = 0; b < blocks; ++b)
+    {
+        process_ensemble_stereo_block(voices.begin(), voices.end(), bus, left.data(), right.data(), left.size(),
+                                      nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f),
+                                      nt::ControlPoint2(0.5f));
+    }
+    stopwatch.stop();
+    sink = left[0] + right[0];
+    return blocks * left.size() * voices.size();
+}
+
+size_t run_fixed_voice(Stopwatch &stopwatch)
+{
+    FixedDeepnoteVoice voice;
+    init_transit(voice, 8, 220.f);
+
+    const size_t samples = 24000;
+    int64_t      sum{0};
+    stopwatch.start();
+    for(size_t i = 0; i < samples; ++i)
+    {
+        sum += process_voice(voice, nt::FixedAnimationMultiplier(1 << 16), nt::FixedControlPoint1(float_to_q31(0.08f)),
+                             nt::FixedControlPoint2(float_to_q31(0.5f)))
+                   .get();
+    }
+    stopwatch.stop();
+    sink = static_cast<float>(sum);
+    return samples;
+}
+
+const Benchmark benchmarks[] = {
+    {"process_voice/4osc/transit", &run_voice<4, false>},
+    {"process_voice/16osc/transit", &run_voice<16, false>},
+    {"process_voice/16osc/steady", &run_voice<16, true>},
+    {"process_oscillators/16osc", &run_oscillators},
+    {"process_voice_block/8osc/64", &run_voice_block},
+    {"ensemble/32voices/64", &run_ensemble},
+    {"ensemble_stereo/32voices/64", &run_ensemble_stereo},
+    {"fixed_voice/8osc/transit", &run_fixed_voice},
+};
+
+struct Options
+{
+    bool        record{false};
+    std::string baseline_path;
+    double      threshold{5.0};
+    double      alpha{0.01};
+    size_t      repetitions{15};
+    std::string filter;
+    bool        footprint{false};
+};
+
+bool parse_options(const int argc, char **argv, Options &options)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        if(std::strcmp(argv[i], "--record") == 0)
+        {
+            options.record = true;
+        }
+        else if(std::strcmp(argv[i], "--baseline") == 0 && has_value)
+        {
+            options.baseline_path = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--threshold") == 0 && has_value)
+        {
+            options.threshold = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--alpha") == 0 && has_value)
+        {
+            options.alpha = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--repetitions") == 0 && has_value)
+        {
+            options.repetitions = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if(std::strcmp(argv[i], "--filter") == 0 && has_value)
+        {
+            options.filter = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--footprint") == 0)
+        {
+            options.footprint = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void print_footprint(std::ostream &os, const char *name, const MemoryFootprint &footprint)
+{
+    os << std::left << std::setw(32) << name << std::right << std::setw(10) << footprint.bytes << std::setw(12)
+       << footprint.get_bytes_per_voice() << std::setw(12) << footprint.voices_in(constants::DAISY_SRAM_BYTES)
+       << std::setw(12) << footprint.voices_in(constants::L2_CACHE_BYTES) << "\n";
+}
+
+void print_footprints(std::ostream &os)
+{
+    os << std::left << std::setw(32) << "" << std::right << std::setw(10) << "bytes" << std::setw(12) << "per voice"
+       << std::setw(12) << "in SRAM" << std::setw(12) << "in L2" << "\n";
+    print_footprint(os, "BasicDeepnoteVoice<4>", footprint<BasicDeepnoteVoice<4>>());
+    print_footprint(os, "BasicDeepnoteVoice<8>", footprint<BasicDeepnoteVoice<8>>());
+    print_footprint(os, "DeepnoteVoice", footprint<DeepnoteVoice>());
+    print_footprint(os, "FixedDeepnoteVoice", footprint<FixedDeepnoteVoice>());
+    print_footprint(os, "VoicePool<64>", footprint<VoicePool<64>>());
+    print_footprint(os, "PartitionedEnsemble<64>", footprint<PartitionedEnsemble<64>>());
+}
+
+bench::Baseline run(const Options &options, bench::PerfCounters &counters)
+{
+    using Counter = bench::CounterValues::Counter;
+
+    bench::Baseline result;
+    result.machine = bench::describe_machine();
+
+    for(const auto &benchmark : benchmarks)
+    {
+        if(std::string(benchmark.name).find(options.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        bench::BenchmarkSamples samples{benchmark.name, "ns/sample", {}, {}};
+        std::array<std::vector<double>, bench::CounterValues::COUNTER_COUNT> counts;
+        std::vector<double>                                                  ipcs;
+        //  the first repetition warms caches and is discarded
+        for(size_t r = 0; r <= options.repetitions; ++r)
+        {
+            Stopwatch    stopwatch(counters);
+            const size_t rendered = benchmark.run(stopwatch);
+            if(r == 0)
+            {
+                continue;
+            }
+            samples.samples.push_back(stopwatch.elapsed_ns / rendered);
+            for(size_t c = 0; c < counts.size(); ++c)
+            {
+                if(stopwatch.values.has(static_cast<Counter>(c)))
+                {
+                    counts[c].push_back(stopwatch.values.get(static_cast<Counter>(c)) / rendered);
+                }
+            }
+            if(stopwatch.values.has(Counter::CYCLES) && stopwatch.values.has(Counter::INSTRUCTIONS))
+            {
+                ipcs.push_back(stopwatch.values.get_ipc());
+            }
+        }
+        for(size_t c = 0; c < counts.size(); ++c)
+        {
+            if(counts[c].size() == options.repetitions)
+            {
+                samples.counters.emplace_back(bench::CounterValues::name(static_cast<Counter>(c)),
+                                              bench::median(counts[c]));
+            }
+        }
+        //  a ratio rather than a count per sample, so it is taken per repetition
+        if(ipcs.size() == options.repetitions)
+        {
+            samples.counters.emplace_back("ipc", bench::median(ipcs));
+        }
+
+        std::cerr << "  " << benchmark.name << ": " << bench::median(samples.samples) << " ns/sample";
+        for(const auto &counter : samples.counters)
+        {
+            std::cerr << ", " << counter.second << " " << counter.first;
+        }
+        std::cerr << "\n";
+        result.benchmarks.push_back(std::move(samples));
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if(!parse_options(argc, argv, options))
+    {
+        std::cerr << "usage: bench [--record] [--baseline FILE] [--threshold PERCENT] [--alpha P] "
+                     "[--repetitions N] [--filter TEXT] [--footprint]\n";
+        return 2;
+    }
+    if(options.footprint)
+    {
+        print_footprints(std::cout);
+        return 0;
+    }
+    if(options.baseline_path.empty())
+    {
+        options.baseline_path = "bench-baseline-" + bench::get_hostname() + ".json";
+    }
+
+    bench::PerfCounters counters;
+    if(!counters.is_available())
+    {
+        std::cerr << "hardware counters unavailable (" << counters.get_unavailable_reason() << "), timing only\n";
+    }
+
+    const auto current = run(options, counters);
+
+    if(options.record)
+    {
+        std::ofstream out(options.baseline_path);
+        bench::write_baseline(out, current);
+        if(!out)
+        {
+            std::cerr << "could not write " << options.baseline_path << "\n";
+            return 2;
+        }
+        std::cout << "recorded baseline " << options.baseline_path << "\n";
+        return 0;
+    }
+
+    std::ifstream in(options.baseline_path);
+    if(!in)
+    {
+        std::cout << "no baseline at " << options.baseline_path << ", run with --record to create one\n";
+        return 0;
+    }
+
+    bench::Baseline baseline;
+    try
+    {
+        baseline = bench::read_baseline(in);
+    }
+    catch(const std::invalid_argument &e)
+    {
+        std::cerr << options.baseline_path << ": " << e.what() << "\n";
+        return 2;
+    }
+
+    if(!bench::same_configuration(baseline.machine, current.machine))
+    {
+        std::cout << "warning: baseline was recorded on " << baseline.machine.cpu_model << " with "
+                  << baseline.machine.compiler << " " << baseline.machine.flags << "\n";
+    }
+
+    const auto comparisons = bench::compare_to_baseline(baseline, current, options.threshold, options.alpha);
+    bench::print_comparison(std::cout, comparisons);
+    bench::print_counter_comparison(std::cout, baseline, current);
+    return bench::has_regression(comparisons) ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file voiceprofile.hpp
+ * @brief Per-call latency distributions for voices, by state and event
+ *
+ * Averages hide the calls that cause dropouts. VoiceLatencyProfile times
+ * individual process_voice() calls and block renders with the cycle counter
+ * and files them by the state the voice was in and by events, such as a
+ * retarget or a state change, that often produce the slowest calls.
+ */
+
+#pragma once
+
+#include "cyclecounter.hpp"
+#include "latencyhistogram.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <ostream>
+
+namespace deepnote
+{
+namespace bench
+{
+
+struct VoiceLatencyProfile
+{
+    enum Event
+    {
+        RETARGET,     //  the first call after set_target_frequency()
+        STATE_CHANGE, //  calls during which the voice changed state
+        EVENT_COUNT
+    };
+
+    static constexpr size_t STATE_COUNT = 3;
+
+    using StateHistograms = std::array<LatencyHistogram, STATE_COUNT>;
+    using EventHistograms = std::array<LatencyHistogram, EVENT_COUNT>;
+
+    VoiceLatencyProfile()
+        : overhead(cycle_counter_overhead())
+    {
+    }
+
+    /**
+     * @brief File the next measured call under RETARGET as well as its state
+     */
+    void mark_retarget() noexcept { retarget_pending = true; }
+
+    /**
+     * @brief Time one process_voice() call
+     */
+    template <typename Voice>
+    nt::OscillatorValue measure_sample(Voice &voice, const nt::AnimationMultiplier lfo_multiplier,
+                                       const nt::ControlPoint1 cp1, const nt::ControlPoint2 cp2)
+    {
+        const auto     state  = voice.get_state();
+        const uint64_t begin  = read_cycle_counter();
+        const auto     output = process_voice(voice, lfo_multiplier, cp1, cp2);
+        const uint64_t end    = read_cycle_counter();
+
+        record(samples_by_state, samples_by_event, voice, state, end - begin);
+        return output;
+    }
+
+    /**
+     * @brief Time one process_voice_block() call
+     */
+    template <typename Voice>
+    void measure_block(Voice &voice, float *out, const size_t count, const nt::AnimationMultiplier lfo_multiplier,
+                       const nt::ControlPoint1 cp1, const nt::ControlPoint2 cp2)
+    {
+        const auto     state = voice.get_state();
+        const uint64_t begin = read_cycle_counter();
+        process_voice_block(voice, out, count, lfo_multiplier, cp1, cp2);
+        const uint64_t end = read_cycle_counter();
+
+        record(blocks_by_state, blocks_by_event, voice, state, end - begin);
+    }
+
+    uint64_t get_overhead() const noexcept { return overhead; }
+
+    StateHistograms samples_by_state;
+    EventHistograms samples_by_event;
+    StateHistograms blocks_by_state;
+    EventHistograms blocks_by_event;
+
+  private:
+    template <typename Voice>
+    void record(StateHistograms &by_state, EventHistograms &by_event, const Voice &voice,
+                const DeepnoteVoiceBase::State state, const uint64_t elapsed)
+    {
+        const uint64_t cycles = elapsed > overhead ? elapsed - overhead : 0;
+        by_state[state].record(cycles);
+        if(retarget_pending)
+        {
+            by_event[RETARGET].record(cycles);
+            retarget_pending = false;
+        }
+        if(voice.get_state() != state)
+        {
+            by_event[STATE_CHANGE].record(cycles);
+        }
+    }
+
+    uint64_t overhead;
+    bool     retarget_pending{false};
+};
+
+inline void print_latency_row(std::ostream &os, const char *name, const LatencyHistogram &histogram)
+{
+    if(histogram.get_count() == 0)
+    {
+        return;
+    }
+    os << std::setw(14) << name << std::setw(10) << histogram.get_count() << std::setw(10)
+       << histogram.percentile(50.0) << std::setw(10) << histogram.percentile(99.0) << std::setw(10)
+       << histogram.percentile(99.9) << std::setw(10) << histogram.get_max() << "\n";
+}
+
+inline std::ostream &operator<<(std::ostream &os, const VoiceLatencyProfile &profile)
+{
+    static const char *const state_names[] = {"PENDING", "IN_TRANSIT", "AT_TARGET"};
+    static const char *const event_names[] = {"RETARGET", "STATE_CHANGE"};
+
+    const auto table = [&](const char *title, const VoiceLatencyProfile::StateHistograms &states,
+                           const VoiceLatencyProfile::EventHistograms &events) {
+        //  a profile usually measures only samples or only blocks, skip the other table
+        const auto empty = [](const LatencyHistogram &histogram) { return histogram.get_count() == 0; };
+        if(std::all_of(states.begin(), states.end(), empty) && std::all_of(events.begin(), events.end(), empty))
+        {
+            return;
+        }
+        os << title << " (" << cycle_counter_unit() << ")\n";
+        os << std::setw(14) << "" << std::setw(10) << "count" << std::setw(10) << "p50" << std::setw(10) << "p99"
+           << std::setw(10) << "p99.9" << std::setw(10) << "max" << "\n";
+        for(size_t i = 0; i < states.size(); ++i)
+        {
+            print_latency_row(os, state_names[i], states[i]);
+        }
+        for(size_t i = 0; i < events.size(); ++i)
+        {
+            print_latency_row(os, event_names[i], events[i]);
+        }
+    };
+
+    table("process_voice", profile.samples_by_state, profile.samples_by_event);
+    table("process_voice_block", profile.blocks_by_state, profile.blocks_by_event);
+    return os;
+}
+
+} // namespace bench
+} // namespace deepnote
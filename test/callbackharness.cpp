@@ -0,0 +1,80 @@
+#include "bench/callbackharness.hpp"
+#include "ensemble/ensemble.hpp"
+#include <doctest/doctest.h>
+#include <sstream>
+
+namespace nt = deepnote::nt;
+
+namespace
+{
+
+void spin_for(const std::chrono::nanoseconds duration)
+{
+    const auto until = std::chrono::steady_clock::now() + duration;
+    while(std::chrono::steady_clock::now() < until)
+    {
+    }
+}
+
+} // namespace
+
+TEST_CASE("Callback harness")
+{
+    deepnote::bench::CallbackHarnessConfig config;
+    config.block_size  = 48;
+    config.sample_rate = 48000.f;
+    config.callbacks   = 100;
+
+    SUBCASE("Deadline follows block size and sample rate")
+    {
+        const auto report = deepnote::bench::run_callback_harness(config, [](float *, size_t) {});
+        CHECK(report.callbacks == 100);
+        CHECK(report.deadline_ns == doctest::Approx(1e6));
+        CHECK(report.compute_ns.get_count() == 100);
+    }
+
+    SUBCASE("Overruns are counted as xruns")
+    {
+        config.paced = false;
+        size_t call{0};
+        const auto report = deepnote::bench::run_callback_harness(config, [&](float *, size_t) {
+            if(call++ % 10 == 0)
+            {
+                spin_for(std::chrono::microseconds(1500));
+            }
+        });
+        CHECK(report.xruns >= 10);
+        CHECK(report.get_peak_load() > 100.0);
+        CHECK(report.compute_ns.percentile(100.0) >= 1500000);
+    }
+
+    SUBCASE("Renders an ensemble in real time")
+    {
+        std::array<deepnote::DeepnoteVoice, 8> voices;
+        for(size_t i = 0; i < voices.size(); ++i)
+        {
+            init_voice(voices[i], 4, nt::OscillatorFrequency(100.f + 50.f * i), nt::SampleRate(config.sample_rate),
+                       nt::OscillatorFrequency(1.f));
+            voices[i].set_target_frequency(nt::OscillatorFrequency(1000.f));
+        }
+
+        config.block_size = 64;
+        config.callbacks  = 150;
+        const auto report = deepnote::bench::run_callback_harness(config, [&](float *out, size_t count) {
+            process_ensemble_block(voices.begin(), voices.end(), out, count, nt::AnimationMultiplier(1.f),
+                                   nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+        });
+
+        std::ostringstream os;
+        os << report;
+        MESSAGE(os.str());
+        CHECK(report.callbacks == 150);
+        CHECK(report.get_mean_load() < 100.0);
+    }
+
+    SUBCASE("Invalid configuration")
+    {
+        config.block_size = 0;
+        CHECK_THROWS_AS(deepnote::bench::run_callback_harness(config, [](float *, size_t) {}), std::invalid_argument);
+    }
+}
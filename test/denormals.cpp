@@ -0,0 +1,43 @@
+#include "util/denormals.hpp"
+#include <doctest/doctest.h>
+#include <limits>
+
+TEST_CASE("ScopedFlushDenormals")
+{
+    volatile float denormal = std::numeric_limits<float>::denorm_min() * 4.f;
+    volatile float small    = std::numeric_limits<float>::min();
+    volatile float half     = 0.5f;
+
+    REQUIRE(denormal * 1.f != 0.f);
+
+    if(!deepnote::ScopedFlushDenormals::is_supported())
+    {
+        MESSAGE("Flush-to-zero is not supported on this target, guard is a no-op");
+        return;
+    }
+
+    SUBCASE("Denormal results flush to zero inside the guard")
+    {
+        const deepnote::ScopedFlushDenormals flush_denormals;
+        CHECK(small * half == 0.f);
+    }
+
+    SUBCASE("Previous mode is restored on exit")
+    {
+        {
+            const deepnote::ScopedFlushDenormals flush_denormals;
+        }
+        CHECK(small * half != 0.f);
+        CHECK(denormal * 1.f != 0.f);
+    }
+
+    SUBCASE("Guards nest")
+    {
+        const deepnote::ScopedFlushDenormals outer;
+        {
+            const deepnote::ScopedFlushDenormals inner;
+            CHECK(small * half == 0.f);
+        }
+        CHECK(small * half == 0.f);
+    }
+}
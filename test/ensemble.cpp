@@ -0,0 +1,73 @@
+#include "ensemble/ensemble.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <array>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+TEST_CASE("process_voice_block")
+{
+    const nt::SampleRate    sample_rate{48000};
+    deepnote::DeepnoteVoice block_voice;
+    deepnote::DeepnoteVoice sample_voice;
+
+    init_voice(block_voice, 3, nt::OscillatorFrequency(400.f), sample_rate, nt::OscillatorFrequency(2.f));
+    init_voice(sample_voice, 3, nt::OscillatorFrequency(400.f), sample_rate, nt::OscillatorFrequency(2.f));
+    block_voice.set_target_frequency(nt::OscillatorFrequency(1200.f));
+    sample_voice.set_target_frequency(nt::OscillatorFrequency(1200.f));
+
+    std::array<float, 256> block{};
+    for(int b = 0; b < 200; ++b)
+    {
+        process_voice_block(block_voice, block.data(), block.size(), nt::AnimationMultiplier(1.f),
+                            nt::ControlPoint1(0.1f), nt::ControlPoint2(0.9f));
+        for(const auto sample : block)
+        {
+            const auto expected = process_voice(sample_voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.1f),
+                                                nt::ControlPoint2(0.9f));
+            REQUIRE(sample == doctest::Approx(expected.get()));
+        }
+    }
+    CHECK(block_voice.is_at_target());
+}
+
+TEST_CASE("process_ensemble_block")
+{
+    const nt::SampleRate                 sample_rate{48000};
+    std::vector<deepnote::DeepnoteVoice> ensemble(4);
+    std::vector<deepnote::DeepnoteVoice> reference(4);
+
+    for(size_t v = 0; v < ensemble.size(); ++v)
+    {
+        const auto start = nt::OscillatorFrequency(100.f + 50.f * v);
+        init_voice(ensemble[v], 2, start, sample_rate, nt::OscillatorFrequency(1.f + v));
+        init_voice(reference[v], 2, start, sample_rate, nt::OscillatorFrequency(1.f + v));
+        ensemble[v].set_target_frequency(nt::OscillatorFrequency(800.f));
+        reference[v].set_target_frequency(nt::OscillatorFrequency(800.f));
+    }
+
+    std::array<float, 64> block{};
+    block.fill(123.f);
+    for(int b = 0; b < 100; ++b)
+    {
+        process_ensemble_block(ensemble.begin(), ensemble.end(), block.data(), block.size(),
+                               nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.25f), nt::ControlPoint2(0.75f));
+
+        std::array<float, 64> expected{};
+        for(auto &voice : reference)
+        {
+            for(auto &sample : expected)
+            {
+                sample += process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.25f),
+                                        nt::ControlPoint2(0.75f))
+                              .get();
+            }
+        }
+
+        for(size_t i = 0; i < block.size(); ++i)
+        {
+            REQUIRE(block[i] == doctest::Approx(expected[i]));
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include "util/fastmath.hpp"
+#include <cmath>
+#include <doctest/doctest.h>
+#include <vector>
+
+TEST_CASE("Fast math")
+{
+    SUBCASE("exp2 is within its error bound")
+    {
+        for(float x = -126.f; x <= 127.f; x += 0.001f)
+        {
+            const double exact = std::exp2(static_cast<double>(x));
+            REQUIRE(std::abs(deepnote::fast_exp2(x) / exact - 1.0) < deepnote::constants::FAST_EXP2_MAX_RELATIVE_ERROR);
+        }
+    }
+
+    SUBCASE("exp2 is exact at integers")
+    {
+        CHECK(deepnote::fast_exp2(0.f) == 1.f);
+        CHECK(deepnote::fast_exp2(1.f) == 2.f);
+        CHECK(deepnote::fast_exp2(-3.f) == 0.125f);
+        CHECK(deepnote::fast_exp2(10.f) == 1024.f);
+    }
+
+    SUBCASE("exp2 clamps out of range inputs")
+    {
+        CHECK(std::isfinite(deepnote::fast_exp2(1000.f)));
+        CHECK(deepnote::fast_exp2(-1000.f) > 0.f);
+    }
+
+    SUBCASE("log2 is within its error bound")
+    {
+        for(float x = 1e-6f; x < 1e6f; x *= 1.0001f)
+        {
+            const double exact = std::log2(static_cast<double>(x));
+            REQUIRE(std::abs(deepnote::fast_log2(x) - exact) < deepnote::constants::FAST_LOG2_MAX_ABSOLUTE_ERROR);
+        }
+        CHECK(deepnote::fast_log2(1.f) == 0.f);
+        CHECK(deepnote::fast_log2(0.25f) == -2.f);
+    }
+
+    SUBCASE("Buffer versions match the scalar versions")
+    {
+        std::vector<float> in(257);
+        for(size_t i = 0; i < in.size(); ++i)
+        {
+            in[i] = 0.1f + 0.37f * i;
+        }
+
+        std::vector<float> out(in.size());
+        deepnote::fast_exp2(in.data(), out.data(), in.size());
+        for(size_t i = 0; i < in.size(); ++i)
+        {
+            REQUIRE(out[i] == deepnote::fast_exp2(in[i]));
+        }
+
+        deepnote::fast_log2(in.data(), out.data(), in.size());
+        for(size_t i = 0; i < in.size(); ++i)
+        {
+            REQUIRE(out[i] == deepnote::fast_log2(in[i]));
+        }
+    }
+}
@@ -0,0 +1,216 @@
+#include "fixedpoint/fixedvoice.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <cmath>
+#include <doctest/doctest.h>
+
+namespace nt = deepnote::nt;
+
+TEST_CASE("Fixed-point formats")
+{
+    CHECK(deepnote::float_to_q31(0.5f) == (1 << 30));
+    CHECK(deepnote::float_to_q31(1.f) == INT32_MAX);
+    CHECK(deepnote::float_to_q31(-1.f) == INT32_MIN);
+    CHECK(deepnote::q31_to_float(deepnote::float_to_q31(0.25f)) == 0.25f);
+
+    CHECK(deepnote::float_to_q16(440.f) == 440 * 65536);
+    CHECK(deepnote::float_to_q16(-2.5f) == -163840);
+    CHECK(deepnote::q16_to_float(deepnote::float_to_q16(1234.5f)) == 1234.5f);
+
+    const auto inc_per_hz = deepnote::phase_inc_per_hz(48000.f);
+    const auto quarter       = deepnote::phase_inc_from_q16(deepnote::float_to_q16(12000.f), inc_per_hz);
+    const auto minus_quarter = deepnote::phase_inc_from_q16(deepnote::float_to_q16(-12000.f), inc_per_hz);
+    CHECK(std::abs(static_cast<int64_t>(quarter) - 0x40000000) < 64);
+    CHECK(std::abs(static_cast<int64_t>(minus_quarter) - 0xc0000000ll) < 64);
+}
+
+TEST_CASE("FixedBezierUnitShaper")
+{
+    const float control_points[][2] = {{0.f, 1.f}, {0.08f, 0.5f}, {0.1f, 0.9f}, {1.f, 0.f}, {-0.5f, 0.75f}};
+    for(const auto &cp : control_points)
+    {
+        const deepnote::BezierUnitShaper      shaper{nt::ControlPoint1(cp[0]), nt::ControlPoint2(cp[1])};
+        const deepnote::FixedBezierUnitShaper fixed_shaper(nt::FixedControlPoint1(deepnote::float_to_q31(cp[0])),
+                                                           nt::FixedControlPoint2(deepnote::float_to_q31(cp[1])));
+        for(int i = 0; i < 1000; ++i)
+        {
+            const float t = i / 1000.f;
+            REQUIRE(std::abs(deepnote::q31_to_float(fixed_shaper(deepnote::float_to_q31(t))) - shaper(t)) < 1e-5f);
+        }
+    }
+}
+
+TEST_CASE("FixedScaler")
+{
+    const deepnote::FixedScaler rising(deepnote::float_to_q16(100.f), deepnote::float_to_q16(500.f));
+    CHECK(rising(0) == deepnote::float_to_q16(100.f));
+    CHECK(rising(deepnote::float_to_q31(0.5f)) == deepnote::float_to_q16(300.f));
+
+    const deepnote::FixedScaler falling(deepnote::float_to_q16(500.f), deepnote::float_to_q16(100.f));
+    CHECK(falling(0) == deepnote::float_to_q16(500.f));
+    CHECK(falling(deepnote::float_to_q31(0.25f)) == deepnote::float_to_q16(400.f));
+}
+
+TEST_CASE("FixedSawOscillator")
+{
+    const float sample_rate = 48000.f;
+    const auto  inc_per_hz  = deepnote::phase_inc_per_hz(sample_rate);
+
+    SUBCASE("Matches the float PolyBLEP sawtooth")
+    {
+        for(const float freq : {55.f, 440.f, 3520.f, 15000.f})
+        {
+            deepnote::SawOscillator reference;
+            reference.init(sample_rate);
+            reference.set_freq(freq);
+
+            deepnote::FixedSawOscillator fixed;
+            fixed.set_phase_inc(deepnote::phase_inc_from_q16(deepnote::float_to_q16(freq), inc_per_hz));
+
+            //  the float phase accumulates rounding, so compare over 10ms
+            for(int i = 0; i < 480; ++i)
+            {
+                const float expected = reference.process();
+                REQUIRE(std::abs(deepnote::q31_to_float(fixed.process()) - expected) < 1e-3f);
+            }
+        }
+    }
+
+    SUBCASE("Negative frequencies run backwards without overflow")
+    {
+        deepnote::FixedSawOscillator fixed;
+        fixed.set_phase_inc(deepnote::phase_inc_from_q16(deepnote::float_to_q16(-440.f), inc_per_hz));
+        for(int i = 0; i < 4800; ++i)
+        {
+            REQUIRE(std::abs(deepnote::q31_to_float(fixed.process())) <= 0.5f);
+        }
+    }
+
+    SUBCASE("Phase does not drift")
+    {
+        deepnote::FixedSawOscillator fixed;
+
+        const auto phase_inc = deepnote::phase_inc_from_q16(deepnote::float_to_q16(440.f), inc_per_hz);
+        fixed.set_phase_inc(phase_inc);
+
+        //  an hour of audio at 48kHz
+        const uint64_t samples = 3600ull * 48000ull;
+        for(uint64_t i = 0; i < samples; ++i)
+        {
+            fixed.process();
+        }
+        CHECK(fixed.get_phase() == static_cast<uint32_t>(samples * phase_inc));
+    }
+}
+
+TEST_CASE("FixedDeepnoteVoice")
+{
+    const nt::SampleRate sample_rate{48000.f};
+
+    const float start_freq  = 200.f;
+    const float target_freq = 1200.f;
+    const float cp1         = 0.08f;
+    const float cp2         = 0.5f;
+
+    deepnote::FixedDeepnoteVoice fixed_voice;
+    init_voice(fixed_voice, 8, nt::OscillatorFrequency(start_freq), sample_rate, nt::OscillatorFrequency(1.f));
+    fixed_voice.set_target_frequency(nt::OscillatorFrequency(target_freq));
+
+    const auto process_fixed = [&]() {
+        return deepnote::fixed_output_to_float(process_voice(fixed_voice, nt::FixedAnimationMultiplier(1 << 16),
+                                                             nt::FixedControlPoint1(deepnote::float_to_q31(cp1)),
+                                                             nt::FixedControlPoint2(deepnote::float_to_q31(cp2))));
+    };
+
+    SUBCASE("Follows the exact transit curve")
+    {
+        //  the float voice's LFO drifts as its phase accumulates rounding, so the
+        //  frequency is checked against the curve evaluated in double precision
+        for(int i = 0; !fixed_voice.is_at_target(); ++i)
+        {
+            process_fixed();
+            const double t     = i / 48000.0;
+            const double u     = 1.0 - t;
+            const double shape = 3 * u * u * t * cp1 + 3 * u * t * t * cp2 + t * t * t;
+            const double exact = start_freq + shape * (target_freq - start_freq);
+            if(!fixed_voice.is_at_target())
+            {
+                REQUIRE(std::abs(fixed_voice.get_current_frequency().get() - exact) < 0.01);
+            }
+        }
+        CHECK(fixed_voice.get_current_frequency().get() == target_freq);
+    }
+
+    SUBCASE("Tracks the float voice")
+    {
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 8, nt::OscillatorFrequency(start_freq), sample_rate, nt::OscillatorFrequency(1.f));
+        voice.set_adaptive_antialiasing(false);
+        voice.set_target_frequency(nt::OscillatorFrequency(target_freq));
+
+        float  max_freq_error{0.f};
+        double squared_error{0.0};
+        for(int i = 0; i < 48000 * 2; ++i)
+        {
+            const float expected = process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(cp1),
+                                                 nt::ControlPoint2(cp2))
+                                       .get();
+            const float actual = process_fixed();
+
+            max_freq_error = std::max(max_freq_error, std::abs(voice.get_current_frequency().get() -
+                                                               fixed_voice.get_current_frequency().get()));
+            //  oscillator phases diverge slowly with the float path's frequency
+            //  drift, so output is compared over the first 100ms
+            if(i < 4800)
+            {
+                squared_error += (expected - actual) * (expected - actual);
+            }
+        }
+
+        CHECK(voice.is_at_target());
+        CHECK(fixed_voice.is_at_target());
+        CHECK(max_freq_error < 0.002f * (target_freq - start_freq));
+        CHECK(std::sqrt(squared_error / 4800) < 0.001);
+    }
+
+    SUBCASE("Descending transit reaches target")
+    {
+        deepnote::FixedDeepnoteVoice fixed_voice;
+        init_voice(fixed_voice, 16, nt::OscillatorFrequency(3000.f), sample_rate, nt::OscillatorFrequency(4.f));
+        fixed_voice.set_target_frequency(nt::OscillatorFrequency(40.f));
+
+        int32_t previous = fixed_voice.get_current_frequency_q16();
+        for(int i = 0; i < 12000 && !fixed_voice.is_at_target(); ++i)
+        {
+            process_voice(fixed_voice, nt::FixedAnimationMultiplier(1 << 16), nt::FixedControlPoint1(0),
+                          nt::FixedControlPoint2(INT32_MAX));
+            REQUIRE(fixed_voice.get_current_frequency_q16() <= previous);
+            previous = fixed_voice.get_current_frequency_q16();
+        }
+        CHECK(fixed_voice.is_at_target());
+        CHECK(fixed_voice.get_current_frequency().get() == 40.f);
+    }
+
+    SUBCASE("Full voice output stays in range")
+    {
+        deepnote::FixedDeepnoteVoice fixed_voice;
+        init_voice(fixed_voice, 16, nt::OscillatorFrequency(20.f), sample_rate, nt::OscillatorFrequency(2.f),
+                   nt::DetuneHz(100.f));
+        fixed_voice.set_target_frequency(nt::OscillatorFrequency(20000.f));
+        for(int i = 0; i < 24000; ++i)
+        {
+            const auto out = process_voice(fixed_voice, nt::FixedAnimationMultiplier(1 << 16),
+                                           nt::FixedControlPoint1(0), nt::FixedControlPoint2(INT32_MAX));
+            REQUIRE(std::abs(deepnote::fixed_output_to_float(out)) <= 16.f * 0.5f);
+        }
+    }
+
+    SUBCASE("Invalid parameters")
+    {
+        deepnote::FixedDeepnoteVoice fixed_voice;
+        CHECK_THROWS_AS(init_voice(fixed_voice, 17, nt::OscillatorFrequency(100.f), sample_rate,
+                                   nt::OscillatorFrequency(1.f)),
+                        std::invalid_argument);
+        init_voice(fixed_voice, 4, nt::OscillatorFrequency(100.f), sample_rate, nt::OscillatorFrequency(1.f));
+        CHECK_THROWS_AS(fixed_voice.scale_lfo_base_freq(nt::FixedAnimationMultiplier(-1)), std::invalid_argument);
+    }
+}
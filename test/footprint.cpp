@@ -0,0 +1,85 @@
+#include "ensemble/footprint.hpp"
+#include "fixedpoint/fixedvoice.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <doctest/doctest.h>
+
+namespace nt = deepnote::nt;
+
+//  the budgets the oscillator and voice layout are sized for
+static_assert(deepnote::footprint<deepnote::DeepnoteVoice>().voices_in(deepnote::constants::L2_CACHE_BYTES) >= 2000,
+              "2000 16 oscillator voices no longer fit in L2");
+static_assert(deepnote::footprint<deepnote::BasicDeepnoteVoice<4>>().voices_in(
+                  deepnote::constants::DAISY_SRAM_BYTES) >= 2000,
+              "2000 4 oscillator voices no longer fit in Daisy SRAM");
+
+TEST_CASE("Voice footprint")
+{
+    SUBCASE("Oscillator bank stores phase, increment and kernel per oscillator")
+    {
+        CHECK(sizeof(deepnote::SawOscillatorBank<16>) == 16 * (2 * sizeof(float) + 1));
+        CHECK(sizeof(deepnote::SawOscillatorBank<16>) < 16 * sizeof(deepnote::SawOscillator));
+    }
+
+    SUBCASE("Each extra oscillator costs its bank entry and detune")
+    {
+        const size_t per_oscillator = 2 * sizeof(float) + 1 + 2 * sizeof(float);
+        CHECK(sizeof(deepnote::BasicDeepnoteVoice<16>) - sizeof(deepnote::BasicDeepnoteVoice<8>) <=
+              8 * per_oscillator + alignof(deepnote::DeepnoteVoice));
+    }
+
+    SUBCASE("Voices")
+    {
+        constexpr auto voice = deepnote::footprint<deepnote::DeepnoteVoice>();
+        CHECK(voice.bytes == sizeof(deepnote::DeepnoteVoice));
+        CHECK(voice.voices == 1);
+        CHECK(voice.get_bytes_per_voice() == sizeof(deepnote::DeepnoteVoice));
+        CHECK(voice.voices_in(10 * sizeof(deepnote::DeepnoteVoice) + 1) == 10);
+
+        MESSAGE("DeepnoteVoice " << voice.bytes << " bytes, "
+                                 << voice.voices_in(deepnote::constants::DAISY_SRAM_BYTES) << " in Daisy SRAM, "
+                                 << voice.voices_in(deepnote::constants::L2_CACHE_BYTES) << " in 1MB L2; "
+                                 << "FixedDeepnoteVoice " << deepnote::footprint<deepnote::FixedDeepnoteVoice>().bytes
+                                 << " bytes");
+    }
+
+    SUBCASE("Ensembles")
+    {
+        using Pool        = deepnote::VoicePool<64>;
+        using Partitioned = deepnote::PartitionedEnsemble<64>;
+
+        constexpr auto pool = deepnote::footprint<Pool>();
+        CHECK(pool.bytes == sizeof(Pool));
+        CHECK(pool.voices == 64);
+        CHECK(pool.get_bytes_per_voice() > sizeof(deepnote::DeepnoteVoice));
+        CHECK(pool.voices_in(2 * sizeof(Pool)) == 128);
+        CHECK(pool.voices_in(sizeof(Pool) - 1) == 0);
+
+        //  voices held outside the ensemble are counted too
+        constexpr auto partitioned = deepnote::footprint<Partitioned>();
+        CHECK(partitioned.bytes == sizeof(Partitioned) + 64 * sizeof(deepnote::DeepnoteVoice));
+        CHECK(partitioned.voices == 64);
+    }
+}
+
+TEST_CASE("Voice assigned mid-transit renders the same")
+{
+    //  the oscillator bank and LFO phase live in the voice, so assignment carries them
+    deepnote::DeepnoteVoice voice;
+    init_voice(voice, 5, nt::OscillatorFrequency(300.f), nt::SampleRate(48000.f), nt::OscillatorFrequency(3.f));
+    voice.set_target_frequency(nt::OscillatorFrequency(900.f));
+    for(int i = 0; i < 1000; ++i)
+    {
+        process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.2f), nt::ControlPoint2(0.8f));
+    }
+
+    deepnote::DeepnoteVoice copy;
+    copy = voice;
+    while(!voice.is_at_target())
+    {
+        const auto expected =
+            process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.2f), nt::ControlPoint2(0.8f));
+        REQUIRE(process_voice(copy, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.2f), nt::ControlPoint2(0.8f))
+                    .get() == expected.get());
+    }
+    CHECK(copy.is_at_target());
+}
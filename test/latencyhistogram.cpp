@@ -0,0 +1,94 @@
+#include "bench/latencyhistogram.hpp"
+#include <doctest/doctest.h>
+#include <sstream>
+
+using deepnote::bench::LatencyHistogram;
+
+TEST_CASE("LatencyHistogram")
+{
+    SUBCASE("Buckets tile the range")
+    {
+        CHECK(LatencyHistogram::bucket_index(0) == 0);
+        CHECK(LatencyHistogram::bucket_index(127) == 127);
+        CHECK(LatencyHistogram::bucket_index(UINT64_MAX) == LatencyHistogram::BUCKET_COUNT - 1);
+        for(size_t i = 1; i < LatencyHistogram::BUCKET_COUNT; ++i)
+        {
+            REQUIRE(LatencyHistogram::bucket_lower(i) == LatencyHistogram::bucket_upper(i - 1) + 1);
+            REQUIRE(LatencyHistogram::bucket_index(LatencyHistogram::bucket_lower(i)) == i);
+            REQUIRE(LatencyHistogram::bucket_index(LatencyHistogram::bucket_upper(i)) == i);
+        }
+        CHECK(LatencyHistogram::bucket_upper(LatencyHistogram::BUCKET_COUNT - 1) == UINT64_MAX);
+    }
+
+    SUBCASE("Small values are exact")
+    {
+        LatencyHistogram histogram;
+        for(uint64_t v = 1; v <= 100; ++v)
+        {
+            histogram.record(v);
+        }
+        CHECK(histogram.get_count() == 100);
+        CHECK(histogram.get_min() == 1);
+        CHECK(histogram.get_max() == 100);
+        CHECK(histogram.get_mean() == doctest::Approx(50.5));
+        CHECK(histogram.percentile(50.0) == 50);
+        CHECK(histogram.percentile(99.0) == 99);
+        CHECK(histogram.percentile(100.0) == 100);
+    }
+
+    SUBCASE("Large values are within bucket resolution")
+    {
+        LatencyHistogram histogram;
+        for(uint64_t v = 1; v <= 100000; ++v)
+        {
+            histogram.record(v * 1000);
+        }
+        for(const double p : {50.0, 90.0, 99.0, 99.9})
+        {
+            const double exact = p / 100.0 * 1e8;
+            CHECK(histogram.percentile(p) >= exact);
+            CHECK(histogram.percentile(p) <= exact * (1.0 + 1.0 / LatencyHistogram::SUB_BUCKETS));
+        }
+        CHECK(histogram.percentile(100.0) == 100000000);
+    }
+
+    SUBCASE("A single outlier sets the tail")
+    {
+        LatencyHistogram histogram;
+        for(int i = 0; i < 999; ++i)
+        {
+            histogram.record(1000);
+        }
+        histogram.record(50000);
+        CHECK(histogram.percentile(99.0) <= 1000 * (1.0 + 1.0 / LatencyHistogram::SUB_BUCKETS));
+        CHECK(histogram.percentile(99.95) == 50000);
+    }
+
+    SUBCASE("Merge and reset")
+    {
+        LatencyHistogram a;
+        LatencyHistogram b;
+        a.record(10);
+        b.record(20);
+        b.record(30);
+        a.merge(b);
+        CHECK(a.get_count() == 3);
+        CHECK(a.get_min() == 10);
+        CHECK(a.get_max() == 30);
+
+        a.reset();
+        CHECK(a.get_count() == 0);
+        CHECK(a.percentile(99.0) == 0);
+    }
+
+    SUBCASE("Printing")
+    {
+        LatencyHistogram histogram;
+        histogram.record(3);
+        histogram.record(1000);
+        std::ostringstream os;
+        deepnote::bench::print_histogram(os, histogram, "ns");
+        CHECK(os.str().find("512 ns") != std::string::npos);
+        CHECK(os.str().find("2 ns") != std::string::npos);
+    }
+}
@@ -0,0 +1,100 @@
+#include "ranges/mapping.hpp"
+#include <doctest/doctest.h>
+#include <type_traits>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+namespace
+{
+deepnote::Scaler make_scaler(const float in_low, const float in_high, const float out_low, const float out_high)
+{
+    return deepnote::Scaler(nt::InputRange(deepnote::Range(nt::RangeLow(in_low), nt::RangeHigh(in_high))),
+                            nt::OutputRange(deepnote::Range(nt::RangeLow(out_low), nt::RangeHigh(out_high))));
+}
+} // namespace
+
+TEST_CASE("Mapping")
+{
+    SUBCASE("Constant mappings fold at compile time")
+    {
+        constexpr auto mapping = deepnote::scale(0.f, 1.f, 0.f, 256.f) | deepnote::scale(0.f, 256.f, -1.f, 1.f);
+        static_assert(std::is_same<decltype(mapping), const deepnote::Affine>::value, "affine stages fold");
+        static_assert(mapping(0.5f) == 0.f, "evaluated at compile time");
+        static_assert(mapping(1.f) == 1.f, "evaluated at compile time");
+
+        constexpr auto shaped = deepnote::bezier(0.f, 1.f) | deepnote::scale(0.f, 1.f, 100.f, 200.f);
+        static_assert(std::is_same<decltype(shaped), const deepnote::Cubic>::value, "cubic and affine fold");
+        static_assert(shaped(0.f) == 100.f, "evaluated at compile time");
+        static_assert(shaped(1.f) == 200.f, "evaluated at compile time");
+    }
+
+    SUBCASE("Matches the scaler, shaper and range chain")
+    {
+        const auto input  = make_scaler(-5.f, 5.f, 0.f, 1.f);
+        const auto shaper = deepnote::BezierUnitShaper(nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+        const auto output = make_scaler(0.f, 1.f, 40.f, 1200.f);
+        const auto limit  = deepnote::Range(nt::RangeLow(50.f), nt::RangeHigh(1000.f));
+
+        const auto fused =
+            deepnote::scale(input) | deepnote::shape(shaper) | deepnote::scale(output) | deepnote::clamp(limit);
+        static_assert(std::is_same<decltype(fused), const deepnote::Chain<deepnote::Cubic, deepnote::Clamp>>::value,
+                      "scaler, shaper and scaler fold into one cubic");
+
+        for(float cv = -5.f; cv <= 5.f; cv += 0.01f)
+        {
+            const float expected = limit.constrain(output(shaper(input(cv))));
+            REQUIRE(fused(cv) == doctest::Approx(expected).epsilon(1e-4));
+        }
+    }
+
+    SUBCASE("Descending output keeps its direction")
+    {
+        const auto mapping = deepnote::scale(0.f, 1.f, 500.f, 100.f);
+        CHECK(mapping(0.f) == 500.f);
+        CHECK(mapping(0.25f) == 400.f);
+        CHECK(mapping(1.f) == 100.f);
+    }
+
+    SUBCASE("Linear shaper is the identity")
+    {
+        const auto mapping = deepnote::scale(0.f, 2.f, 0.f, 1.f) | deepnote::shape(deepnote::LinearUnitShaper());
+        CHECK(mapping(1.f) == 0.5f);
+    }
+
+    SUBCASE("Stages after a clamp keep folding")
+    {
+        const auto mapping = deepnote::clamp(0.f, 1.f) | deepnote::bezier(0.2f, 0.8f) |
+                             deepnote::scale(0.f, 1.f, 0.f, 10.f);
+        static_assert(std::is_same<decltype(mapping), const deepnote::Chain<deepnote::Clamp, deepnote::Cubic>>::value,
+                      "trailing affine folds into the cubic");
+
+        const deepnote::BezierUnitShaper shaper{nt::ControlPoint1(0.2f), nt::ControlPoint2(0.8f)};
+        CHECK(mapping(-1.f) == doctest::Approx(0.f));
+        CHECK(mapping(2.f) == doctest::Approx(10.f));
+        CHECK(mapping(0.3f) == doctest::Approx(10.f * shaper(0.3f)));
+    }
+
+    SUBCASE("Cubics that don't fold are chained")
+    {
+        const auto mapping = deepnote::bezier(0.2f, 0.8f) | deepnote::bezier(0.9f, 0.1f);
+        static_assert(std::is_same<decltype(mapping), const deepnote::Chain<deepnote::Cubic, deepnote::Cubic>>::value,
+                      "degree nine does not fold");
+
+        const deepnote::BezierUnitShaper first{nt::ControlPoint1(0.2f), nt::ControlPoint2(0.8f)};
+        const deepnote::BezierUnitShaper second{nt::ControlPoint1(0.9f), nt::ControlPoint2(0.1f)};
+        CHECK(mapping(0.4f) == doctest::Approx(second(first(0.4f))));
+    }
+
+    SUBCASE("Processes buffers")
+    {
+        const auto         mapping = deepnote::scale(0.f, 1.f, 100.f, 200.f) | deepnote::clamp(100.f, 150.f);
+        std::vector<float> in{0.f, 0.25f, 0.5f, 0.75f, 1.f};
+        std::vector<float> out(in.size());
+        mapping.process(in.data(), out.data(), in.size());
+        CHECK(out == std::vector<float>{100.f, 125.f, 150.f, 150.f, 150.f});
+
+        mapping.process(in.data(), in.data(), in.size());
+        CHECK(in == out);
+    }
+}
@@ -0,0 +1,142 @@
+#include "ensemble/ensemble.hpp"
+#include "ensemble/mixbus.hpp"
+#include <cmath>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+TEST_CASE("MixBus")
+{
+    deepnote::MixBus<4>      bus;
+    const std::vector<float> ones(256, 1.f);
+    std::vector<float>       left(ones.size(), 0.f);
+    std::vector<float>       right(ones.size(), 0.f);
+
+    SUBCASE("Centred unity gain is 3dB down in each side")
+    {
+        bus.mix(0, ones.data(), ones.size(), left.data(), right.data());
+        CHECK(left[0] == doctest::Approx(std::sqrt(0.5f)));
+        CHECK(right[0] == doctest::Approx(std::sqrt(0.5f)));
+    }
+
+    SUBCASE("Power is constant across pan")
+    {
+        for(float pan = -1.f; pan <= 1.f; pan += 0.125f)
+        {
+            bus.set_pan(1, pan);
+            bus.set_gain(1, 0.5f);
+            bus.snap();
+            std::fill(left.begin(), left.end(), 0.f);
+            std::fill(right.begin(), right.end(), 0.f);
+            bus.mix(1, ones.data(), 1, left.data(), right.data());
+            CHECK(left[0] * left[0] + right[0] * right[0] == doctest::Approx(0.25f));
+        }
+    }
+
+    SUBCASE("Hard pans reach one side only")
+    {
+        bus.set_pan(0, -1.f);
+        bus.set_pan(1, 2.f);
+        CHECK(bus.get_pan(1) == 1.f);
+        bus.snap();
+        bus.mix(0, ones.data(), 1, left.data(), right.data());
+        CHECK(left[0] == doctest::Approx(1.f));
+        CHECK(right[0] == doctest::Approx(0.f));
+
+        left[0] = right[0] = 0.f;
+        bus.mix(1, ones.data(), 1, left.data(), right.data());
+        CHECK(left[0] == doctest::Approx(0.f));
+        CHECK(right[0] == doctest::Approx(1.f));
+    }
+
+    SUBCASE("Changes ramp smoothly across blocks")
+    {
+        bus.set_gain(2, 0.f);
+        bus.snap();
+        bus.set_gain(2, 1.f);
+
+        //  blocks shorter than the ramp
+        for(size_t offset = 0; offset < ones.size(); offset += 16)
+        {
+            bus.mix(2, ones.data(), 16, left.data() + offset, right.data() + offset);
+        }
+        for(size_t i = 1; i < deepnote::constants::MIX_BUS_RAMP_SAMPLES; ++i)
+        {
+            REQUIRE(left[i] > left[i - 1]);
+        }
+        CHECK(left[deepnote::constants::MIX_BUS_RAMP_SAMPLES - 1] == doctest::Approx(std::cos(0.785398163f)));
+        for(size_t i = deepnote::constants::MIX_BUS_RAMP_SAMPLES; i < ones.size(); ++i)
+        {
+            REQUIRE(left[i] == std::cos(0.785398163f));
+        }
+    }
+
+    SUBCASE("Interleaved matches planar")
+    {
+        bus.set_pan(3, 0.3f);
+        bus.set_gain(3, 0.7f);
+        deepnote::MixBus<4> other;
+        other.set_pan(3, 0.3f);
+        other.set_gain(3, 0.7f);
+
+        std::vector<float> in(ones.size());
+        for(size_t i = 0; i < in.size(); ++i)
+        {
+            in[i] = std::sin(0.1f * i);
+        }
+        std::vector<float> stereo(2 * in.size(), 0.f);
+        bus.mix(3, in.data(), in.size(), left.data(), right.data());
+        other.mix_interleaved(3, in.data(), in.size(), stereo.data());
+        for(size_t i = 0; i < in.size(); ++i)
+        {
+            REQUIRE(stereo[2 * i] == left[i]);
+            REQUIRE(stereo[2 * i + 1] == right[i]);
+        }
+    }
+
+    SUBCASE("Channels are range checked")
+    {
+        CHECK_THROWS_AS(bus.set_gain(4, 1.f), std::invalid_argument);
+        CHECK_THROWS_AS(bus.mix(4, ones.data(), 1, left.data(), right.data()), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Ensemble stereo rendering")
+{
+    const nt::SampleRate                   sample_rate{48000.f};
+    std::array<deepnote::DeepnoteVoice, 3> voices;
+    std::array<deepnote::DeepnoteVoice, 3> reference;
+    for(auto *ensemble : {&voices, &reference})
+    {
+        for(size_t i = 0; i < ensemble->size(); ++i)
+        {
+            init_voice((*ensemble)[i], 4, nt::OscillatorFrequency(50.f * (i + 1)), sample_rate,
+                       nt::OscillatorFrequency(1.f));
+            (*ensemble)[i].set_target_frequency(nt::OscillatorFrequency(400.f));
+        }
+    }
+
+    //  every voice hard left at unity gain sums to the mono ensemble
+    deepnote::MixBus<3> bus;
+    for(size_t i = 0; i < bus.capacity(); ++i)
+    {
+        bus.set_pan(i, -1.f);
+    }
+    bus.snap();
+
+    const size_t       count = 1000;
+    std::vector<float> left(count);
+    std::vector<float> right(count);
+    std::vector<float> mono(count);
+    process_ensemble_stereo_block(voices.begin(), voices.end(), bus, left.data(), right.data(), count,
+                                  nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.1f), nt::ControlPoint2(0.9f));
+    process_ensemble_block(reference.begin(), reference.end(), mono.data(), count, nt::AnimationMultiplier(1.f),
+                           nt::ControlPoint1(0.1f), nt::ControlPoint2(0.9f));
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        REQUIRE(left[i] == doctest::Approx(mono[i]).epsilon(1e-5));
+        REQUIRE(std::abs(right[i]) < 1e-6f);
+    }
+}
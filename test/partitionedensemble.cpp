@@ -0,0 +1,139 @@
+#include "ensemble/partitionedensemble.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <array>
+#include <doctest/doctest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+namespace
+{
+using Ensemble = deepnote::PartitionedEnsemble<8>;
+
+void init_mixed_voices(std::vector<deepnote::DeepnoteVoice> &voices)
+{
+    const nt::SampleRate sample_rate{48000};
+    for(size_t v = 0; v < voices.size(); ++v)
+    {
+        init_voice(voices[v], 2, nt::OscillatorFrequency(100.f + 50.f * v), sample_rate,
+                   nt::OscillatorFrequency(4.f + v));
+        //  every third voice stays at its start frequency
+        if(v % 3 != 0)
+        {
+            voices[v].set_target_frequency(nt::OscillatorFrequency(800.f - 40.f * v));
+        }
+    }
+}
+
+void check_groups(Ensemble &ensemble)
+{
+    size_t position{0};
+    for(const auto state : {deepnote::DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET,
+                            deepnote::DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET, deepnote::DeepnoteVoiceBase::AT_TARGET})
+    {
+        const size_t end = position + ensemble.get_group_size(state);
+        for(; position < end; ++position)
+        {
+            REQUIRE(ensemble.get_voice(ensemble.get_id_at(position)).get_state() == state);
+        }
+    }
+    REQUIRE(position == ensemble.get_voice_count());
+}
+} // namespace
+
+TEST_CASE("PartitionedEnsemble matches process_voice")
+{
+    std::vector<deepnote::DeepnoteVoice> voices(7);
+    init_mixed_voices(voices);
+    std::vector<deepnote::DeepnoteVoice> reference(voices);
+
+    Ensemble ensemble;
+    for(auto &voice : voices)
+    {
+        ensemble.add(voice);
+    }
+    check_groups(ensemble);
+    CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET) == voices.size());
+
+    //  odd block size so voices arrive part way through a block
+    std::array<float, 61> block{};
+    for(int b = 0; b < 400; ++b)
+    {
+        std::array<float, 61> expected{};
+        for(size_t position = 0; position < ensemble.get_voice_count(); ++position)
+        {
+            auto &voice = reference[ensemble.get_id_at(position)];
+            for(auto &sample : expected)
+            {
+                sample += process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.25f),
+                                        nt::ControlPoint2(0.75f))
+                              .get();
+            }
+        }
+
+        ensemble.process_block(block.data(), block.size(), nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.25f),
+                               nt::ControlPoint2(0.75f));
+        for(size_t i = 0; i < block.size(); ++i)
+        {
+            REQUIRE(block[i] == expected[i]);
+        }
+        check_groups(ensemble);
+        if(b == 0)
+        {
+            CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET) == 4);
+            CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::AT_TARGET) == 3);
+        }
+
+        //  retarget through the ensemble mid-render
+        if(b == 150)
+        {
+            ensemble.set_target_frequency(2, nt::OscillatorFrequency(300.f));
+            reference[2].set_target_frequency(nt::OscillatorFrequency(300.f));
+            check_groups(ensemble);
+        }
+    }
+
+    for(size_t v = 0; v < voices.size(); ++v)
+    {
+        CHECK(voices[v].is_at_target());
+        CHECK(voices[v].get_current_frequency().get() == reference[v].get_current_frequency().get());
+    }
+    CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::AT_TARGET) == voices.size());
+}
+
+TEST_CASE("PartitionedEnsemble moves voices between groups")
+{
+    std::vector<deepnote::DeepnoteVoice> voices(8);
+    init_mixed_voices(voices);
+
+    Ensemble ensemble;
+    for(auto &voice : voices)
+    {
+        ensemble.add(voice);
+    }
+
+    std::array<float, 32> block{};
+    ensemble.process_block(block.data(), block.size(), nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.25f),
+                           nt::ControlPoint2(0.75f));
+    CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET) == 0);
+    CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET) == 5);
+    check_groups(ensemble);
+
+    //  at target and in transit voices both move back to pending
+    ensemble.set_target_frequency(0, nt::OscillatorFrequency(500.f));
+    ensemble.set_target_frequency(1, nt::OscillatorFrequency(500.f));
+    CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET) == 2);
+    CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET) == 4);
+    CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::AT_TARGET) == 2);
+    check_groups(ensemble);
+
+    //  state changed behind the ensemble's back
+    voices[3].set_target_frequency(nt::OscillatorFrequency(200.f));
+    ensemble.update_group(3);
+    CHECK(ensemble.get_group_size(deepnote::DeepnoteVoiceBase::PENDING_TRANSIT_TO_TARGET) == 3);
+    check_groups(ensemble);
+
+    deepnote::DeepnoteVoice extra;
+    CHECK_THROWS_AS(ensemble.add(extra), std::invalid_argument);
+}
@@ -0,0 +1,48 @@
+#include "bench/perfcounters.hpp"
+#include <doctest/doctest.h>
+
+using deepnote::bench::CounterValues;
+
+TEST_CASE("Hardware performance counters")
+{
+    deepnote::bench::PerfCounters counters;
+
+    //  volatile keeps the loop from being folded away
+    volatile double sum{0.0};
+    counters.start();
+    for(int i = 0; i < 100000; ++i)
+    {
+        sum = sum + i;
+    }
+    const auto values = counters.stop();
+
+    if(!counters.is_available())
+    {
+        MESSAGE("hardware counters unavailable: " << counters.get_unavailable_reason());
+        CHECK_FALSE(counters.get_unavailable_reason().empty());
+        for(size_t c = 0; c < CounterValues::COUNTER_COUNT; ++c)
+        {
+            CHECK_FALSE(values.has(static_cast<CounterValues::Counter>(c)));
+        }
+        CHECK(values.get_ipc() == 0.0);
+        return;
+    }
+
+    if(values.has(CounterValues::INSTRUCTIONS))
+    {
+        //  at least a load, add and store per iteration
+        CHECK(values.get(CounterValues::INSTRUCTIONS) > 100000.0);
+    }
+    if(values.has(CounterValues::CYCLES) && values.has(CounterValues::INSTRUCTIONS))
+    {
+        CHECK(values.get_ipc() > 0.0);
+    }
+
+    //  counters restart from zero
+    counters.start();
+    const auto empty = counters.stop();
+    if(values.has(CounterValues::INSTRUCTIONS) && empty.has(CounterValues::INSTRUCTIONS))
+    {
+        CHECK(empty.get(CounterValues::INSTRUCTIONS) < values.get(CounterValues::INSTRUCTIONS));
+    }
+}
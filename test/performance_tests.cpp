@@ -1,9 +1,15 @@
+#include "bench/voiceprofile.hpp"
+#include "ensemble/ensemble.hpp"
+#include "ensemble/mixbus.hpp"
+#include "ensemble/partitionedensemble.hpp"
 #include "voice/deepnotevoice.hpp"
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <doctest/doctest.h>
 #include <numeric>
+#include <sstream>
 #include <vector>
 
 using namespace deepnote;
@@ -375,3 +381,192 @@ TEST_CASE("Performance regression detection")
         }
     }
 }
+
+TEST_CASE("Tail latency by voice state")
+{
+    bench::VoiceLatencyProfile profile;
+
+    DeepnoteVoice voice;
+    init_voice(voice, 8, nt::OscillatorFrequency(220.0f), nt::SampleRate(48000.0f), nt::OscillatorFrequency(4.0f));
+
+    const nt::AnimationMultiplier multiplier(1.0f);
+    const nt::ControlPoint1       cp1(0.08f);
+    const nt::ControlPoint2       cp2(0.5f);
+    const float                   targets[] = {880.0f, 110.0f, 1760.0f, 440.0f};
+
+    SUBCASE("Per sample")
+    {
+        // Each transit takes a quarter of a second, then the voice holds at target
+        for(const float target : targets)
+        {
+            voice.set_target_frequency(nt::OscillatorFrequency(target));
+            profile.mark_retarget();
+            for(int i = 0; i < 24000; ++i)
+            {
+                profile.measure_sample(voice, multiplier, cp1, cp2);
+            }
+        }
+    }
+
+    SUBCASE("Per block")
+    {
+        std::vector<float> block(64);
+        for(const float target : targets)
+        {
+            voice.set_target_frequency(nt::OscillatorFrequency(target));
+            profile.mark_retarget();
+            for(int i = 0; i < 24000 / 64; ++i)
+            {
+                profile.measure_block(voice, block.data(), block.size(), multiplier, cp1, cp2);
+            }
+        }
+    }
+
+    std::ostringstream report;
+    report << profile;
+    MESSAGE(report.str());
+
+    //  only the table that was measured is printed
+    const bool per_sample = profile.samples_by_state[0].get_count() > 0;
+    CHECK((report.str().find("process_voice (") != std::string::npos) == per_sample);
+    CHECK((report.str().find("process_voice_block (") != std::string::npos) == !per_sample);
+
+    const auto &by_state = profile.samples_by_state[0].get_count() > 0 ? profile.samples_by_state
+                                                                       : profile.blocks_by_state;
+    const auto &by_event = profile.samples_by_state[0].get_count() > 0 ? profile.samples_by_event
+                                                                       : profile.blocks_by_event;
+    for(const auto &histogram : by_state)
+    {
+        REQUIRE(histogram.get_count() > 0);
+        CHECK(histogram.percentile(50.0) <= histogram.percentile(99.0));
+        CHECK(histogram.percentile(99.0) <= histogram.percentile(99.9));
+        CHECK(histogram.percentile(99.9) <= histogram.get_max());
+    }
+    CHECK(by_event[bench::VoiceLatencyProfile::RETARGET].get_count() == 4);
+    CHECK(by_event[bench::VoiceLatencyProfile::STATE_CHANGE].get_count() >= 4);
+}
+
+TEST_CASE("Partitioned ensemble throughput by state mix")
+{
+    //  16 voices, each either held at target or on a transit slow enough to
+    //  last the whole render
+    const auto render_seconds = [](const size_t in_transit) {
+        std::vector<DeepnoteVoice> voices(16);
+        PartitionedEnsemble<16>    ensemble;
+        for(size_t v = 0; v < voices.size(); ++v)
+        {
+            init_voice(voices[v], 8, nt::OscillatorFrequency(100.0f + 20.0f * v), nt::SampleRate(48000.0f),
+                       nt::OscillatorFrequency(0.05f));
+            //  spread the transits through the ensemble rather than bunching them
+            if((v * in_transit) % voices.size() + in_transit >= voices.size())
+            {
+                voices[v].set_target_frequency(nt::OscillatorFrequency(1000.0f + 20.0f * v));
+            }
+            ensemble.add(voices[v]);
+        }
+
+        std::vector<float> block(64);
+        auto               start_time = std::chrono::high_resolution_clock::now();
+        for(int b = 0; b < 48000 / 64; ++b)
+        {
+            ensemble.process_block(block.data(), block.size(), nt::AnimationMultiplier(1.0f),
+                                   nt::ControlPoint1(0.25f), nt::ControlPoint2(0.75f));
+            REQUIRE(std::isfinite(block[0]));
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        REQUIRE(ensemble.get_group_size(DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET) == in_transit);
+        return std::chrono::duration<double>(end_time - start_time).count();
+    };
+
+    double at_target = 1e9;
+    double transit   = 1e9;
+    double mixed     = 1e9;
+    for(int run = 0; run < 3; ++run)
+    {
+        at_target = std::min(at_target, render_seconds(0));
+        transit   = std::min(transit, render_seconds(16));
+        mixed     = std::min(mixed, render_seconds(8));
+    }
+
+    //  a half and half mix should cost what its two halves cost on their own
+    const double expected = 0.5 * (at_target + transit);
+    MESSAGE("1s of 16 voices x 8 oscillators: at target " << at_target * 1000.0 << "ms, in transit "
+                                                           << transit * 1000.0 << "ms, half and half "
+                                                           << mixed * 1000.0 << "ms");
+    CHECK(mixed < expected * 1.5);
+}
+
+TEST_CASE("Denormal protection")
+{
+    SUBCASE("Guarded render avoids the denormal slow path")
+    {
+        //  Voices faded down to the bottom of the float range on the mix bus:
+        //  gain times a saw sample lands in the subnormal range, so without
+        //  flush-to-zero every mix multiply-add takes the slow path
+        const auto render_ms = [](const float gain, const bool guarded) {
+            std::vector<DeepnoteVoice> voices(32);
+            MixBus<32>                 bus;
+            for(size_t v = 0; v < voices.size(); ++v)
+            {
+                init_voice(voices[v], 1, nt::OscillatorFrequency(110.0f * (1 + v)), nt::SampleRate(48000.0f),
+                           nt::OscillatorFrequency(1.0f));
+                bus.set_gain(v, gain);
+            }
+            bus.snap();
+
+            std::vector<float>                                  left(256);
+            std::vector<float>                                  right(256);
+            std::array<float, constants::MIX_BUS_CHUNK_SAMPLES> chunk;
+            auto start_time = std::chrono::high_resolution_clock::now();
+            for(int b = 0; b < 48000 / 256; ++b)
+            {
+                if(guarded)
+                {
+                    process_ensemble_stereo_block(voices.begin(), voices.end(), bus, left.data(), right.data(),
+                                                  left.size(), nt::AnimationMultiplier(1.0f),
+                                                  nt::ControlPoint1(0.25f), nt::ControlPoint2(0.75f));
+                    continue;
+                }
+
+                //  the same render as process_ensemble_stereo_block() without its guard
+                std::fill(left.begin(), left.end(), 0.f);
+                std::fill(right.begin(), right.end(), 0.f);
+                for(size_t v = 0; v < voices.size(); ++v)
+                {
+                    for(size_t offset = 0; offset < left.size(); offset += chunk.size())
+                    {
+                        for(auto &sample : chunk)
+                        {
+                            sample = process_voice(voices[v], nt::AnimationMultiplier(1.0f), nt::ControlPoint1(0.25f),
+                                                   nt::ControlPoint2(0.75f))
+                                         .get();
+                        }
+                        bus.mix(v, chunk.data(), chunk.size(), left.data() + offset, right.data() + offset);
+                    }
+                }
+            }
+            auto end_time = std::chrono::high_resolution_clock::now();
+            REQUIRE(std::isfinite(left[0]));
+            return std::chrono::duration<double, std::milli>(end_time - start_time).count();
+        };
+
+        double normal    = 1e9;
+        double guarded   = 1e9;
+        double unguarded = 1e9;
+        for(int run = 0; run < 3; ++run)
+        {
+            normal    = std::min(normal, render_ms(0.5f, true));
+            guarded   = std::min(guarded, render_ms(2e-38f, true));
+            unguarded = std::min(unguarded, render_ms(2e-38f, false));
+        }
+
+        MESSAGE("1s of 32 voices mixed: normal gain " << normal << "ms, subnormal gain " << guarded
+                                                      << "ms guarded, " << unguarded << "ms unguarded");
+
+        if(ScopedFlushDenormals::is_supported())
+        {
+            CHECK(guarded < normal * 2.0);
+            CHECK(unguarded > guarded * 3.0);
+        }
+    }
+}
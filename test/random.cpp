@@ -0,0 +1,186 @@
+#include "fixedpoint/fixedvoice.hpp"
+#include "util/random.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <array>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+TEST_CASE("Philox4x32-10")
+{
+    //  known answers from the Random123 distribution
+    CHECK(deepnote::philox4x32({{0, 0, 0, 0}}, {{0, 0}}) ==
+          deepnote::PhiloxCounter{{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}});
+    CHECK(deepnote::philox4x32({{UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX}}, {{UINT32_MAX, UINT32_MAX}}) ==
+          deepnote::PhiloxCounter{{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}});
+    CHECK(deepnote::philox4x32({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}}, {{0xa4093822, 0x299f31d0}}) ==
+          deepnote::PhiloxCounter{{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}});
+
+    CHECK(deepnote::random_bits_to_unit(0) == 0.f);
+    CHECK(deepnote::random_bits_to_unit(UINT32_MAX) < 1.f);
+}
+
+TEST_CASE("RandomStream")
+{
+    const nt::RandomSeed seed(0x1975deadbeefull);
+
+    SUBCASE("Streams are reproducible and independent")
+    {
+        deepnote::RandomStream a(seed, 3);
+        deepnote::RandomStream b(seed, 3);
+        deepnote::RandomStream other_stream(seed, 4);
+        deepnote::RandomStream other_seed(nt::RandomSeed(seed.get() + 1), 3);
+
+        int same_as_other_stream{0};
+        int same_as_other_seed{0};
+        for(int i = 0; i < 1000; ++i)
+        {
+            const uint32_t value = a.next_uint32();
+            REQUIRE(value == b.next_uint32());
+            same_as_other_stream += value == other_stream.next_uint32();
+            same_as_other_seed += value == other_seed.next_uint32();
+        }
+        CHECK(same_as_other_stream == 0);
+        CHECK(same_as_other_seed == 0);
+    }
+
+    SUBCASE("Any position can be reached directly")
+    {
+        deepnote::RandomStream sequential(seed, 7);
+        std::vector<uint32_t>  values(103);
+        for(auto &value : values)
+        {
+            value = sequential.next_uint32();
+        }
+        CHECK(sequential.get_position() == values.size());
+
+        deepnote::RandomStream jumping(seed, 7);
+        for(const uint64_t position : {90u, 1u, 102u, 0u, 45u})
+        {
+            CHECK(jumping.at(position) == values[position]);
+            jumping.seek(position);
+            CHECK(jumping.next_uint32() == values[position]);
+        }
+    }
+
+    SUBCASE("Buffer fill matches sequential draws")
+    {
+        for(const size_t offset : {0u, 1u, 3u})
+        {
+            for(const size_t count : {0u, 2u, 4u, 37u})
+            {
+                deepnote::RandomStream sequential(seed, 1);
+                deepnote::RandomStream buffered(seed, 1);
+                sequential.seek(offset);
+                buffered.seek(offset);
+
+                std::vector<float> buffer(count);
+                buffered.fill_unit(buffer.data(), count);
+                for(size_t i = 0; i < count; ++i)
+                {
+                    REQUIRE(buffer[i] == sequential.next_unit());
+                }
+                CHECK(buffered.get_position() == sequential.get_position());
+                CHECK(buffered.next_uint32() == sequential.next_uint32());
+            }
+        }
+    }
+
+    SUBCASE("Values are uniform")
+    {
+        deepnote::RandomStream random(seed, 0);
+        std::vector<float>     values(40000);
+        random.fill_unit(values.data(), values.size());
+
+        std::array<int, 10> buckets{};
+        for(const float value : values)
+        {
+            REQUIRE(value >= 0.f);
+            REQUIRE(value < 1.f);
+            ++buckets[static_cast<size_t>(value * 10)];
+        }
+        //  chi-squared with 9 degrees of freedom, p < 0.001 above 27.9
+        double chi_squared{0.0};
+        for(const int bucket : buckets)
+        {
+            chi_squared += (bucket - 4000.0) * (bucket - 4000.0) / 4000.0;
+        }
+        CHECK(chi_squared < 27.9);
+
+        for(int i = 0; i < 1000; ++i)
+        {
+            const float value = random.next_uniform(200.f, 400.f);
+            REQUIRE(value >= 200.f);
+            REQUIRE(value < 400.f);
+        }
+    }
+}
+
+TEST_CASE("Random voice initialization")
+{
+    const nt::SampleRate  sample_rate{48000.f};
+    const nt::RandomSeed  seed(1975);
+    const deepnote::Range start_range(nt::RangeLow(200.f), nt::RangeHigh(400.f));
+    const size_t          voice_count = 8;
+
+    const auto render = [&](deepnote::DeepnoteVoice &voice) {
+        std::vector<float> out(2048);
+        for(auto &sample : out)
+        {
+            sample = process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f),
+                                   nt::ControlPoint2(0.5f))
+                         .get();
+        }
+        return out;
+    };
+
+    std::array<deepnote::DeepnoteVoice, voice_count> forward;
+    std::array<deepnote::DeepnoteVoice, voice_count> reverse;
+    for(size_t i = 0; i < voice_count; ++i)
+    {
+        deepnote::RandomStream random(seed, i);
+        init_voice(forward[i], 8, start_range, sample_rate, nt::OscillatorFrequency(0.5f), nt::DetuneHz(2.5f), random);
+    }
+    //  initialising in a different order, as separate shards or threads would,
+    //  gives the same voices
+    for(size_t i = voice_count; i-- > 0;)
+    {
+        deepnote::RandomStream random(seed, i);
+        init_voice(reverse[i], 8, start_range, sample_rate, nt::OscillatorFrequency(0.5f), nt::DetuneHz(2.5f), random);
+    }
+
+    for(size_t i = 0; i < voice_count; ++i)
+    {
+        CAPTURE(i);
+        CHECK(start_range.contains(forward[i].get_start_frequency().get()));
+        CHECK(forward[i].get_start_frequency() == reverse[i].get_start_frequency());
+        CHECK(forward[i].get_current_frequency() == forward[i].get_start_frequency());
+        CHECK(render(forward[i]) == render(reverse[i]));
+        if(i > 0)
+        {
+            CHECK(!(forward[i].get_start_frequency() == forward[i - 1].get_start_frequency()));
+        }
+    }
+
+    SUBCASE("A single oscillator is not detuned")
+    {
+        deepnote::DeepnoteVoice voice;
+        deepnote::RandomStream  random(seed, 0);
+        init_voice(voice, 1, start_range, sample_rate, nt::OscillatorFrequency(0.5f), nt::DetuneHz(2.5f), random);
+        CHECK(random.get_position() == 2);
+
+        deepnote::DeepnoteVoice reference;
+        init_voice(reference, 1, voice.get_start_frequency(), sample_rate, nt::OscillatorFrequency(0.5f));
+        CHECK(render(voice) == render(reference));
+    }
+
+    SUBCASE("Fixed-point voices draw the same values")
+    {
+        deepnote::FixedDeepnoteVoice fixed;
+        deepnote::RandomStream       random(seed, 5);
+        init_voice(fixed, 8, start_range, sample_rate, nt::OscillatorFrequency(0.5f), nt::DetuneHz(2.5f), random);
+        CHECK(random.get_position() == 9);
+        CHECK(std::abs(fixed.get_start_frequency().get() - forward[5].get_start_frequency().get()) < 1e-4f);
+    }
+}
@@ -1,5 +1,6 @@
 #include "ranges/range.hpp"
 #include <doctest/doctest.h>
+#include <vector>
 
 namespace nt = deepnote::nt;
 
@@ -30,3 +31,45 @@ TEST_CASE("Range")
         CHECK(range.length() == 5);
     }
 }
+
+TEST_CASE("Range buffers")
+{
+    const deepnote::Range range(nt::RangeLow(-1.f), nt::RangeHigh(1.f));
+
+    std::vector<float> values(70);
+    for(size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = -2.f + 0.06f * i;
+    }
+
+    SUBCASE("contains writes one bit per value")
+    {
+        CHECK(deepnote::Range::mask_words(0) == 0);
+        CHECK(deepnote::Range::mask_words(32) == 1);
+        CHECK(deepnote::Range::mask_words(70) == 3);
+
+        std::vector<uint32_t> mask(deepnote::Range::mask_words(values.size()), 0xffffffffu);
+        range.contains(values.data(), mask.data(), values.size());
+        for(size_t i = 0; i < values.size(); ++i)
+        {
+            const bool bit = (mask[i / 32] >> (i % 32)) & 1u;
+            REQUIRE(bit == range.contains(values[i]));
+        }
+
+        //  bits past the end of the buffer are cleared
+        CHECK((mask[2] >> 6) == 0);
+    }
+
+    SUBCASE("constrain matches the scalar version")
+    {
+        std::vector<float> out(values.size());
+        range.constrain(values.data(), out.data(), values.size());
+        for(size_t i = 0; i < values.size(); ++i)
+        {
+            REQUIRE(out[i] == range.constrain(values[i]));
+        }
+
+        range.constrain(values.data(), values.data(), values.size());
+        CHECK(values == out);
+    }
+}
@@ -0,0 +1,216 @@
+#include "ensemble/voicepool.hpp"
+#include "fixedpoint/fixedvoice.hpp"
+#include "reference/golden.hpp"
+#include <doctest/doctest.h>
+
+namespace nt = deepnote::nt;
+
+using deepnote::reference::Scenario;
+
+namespace
+{
+
+void configure_engine(deepnote::DeepnoteVoice &voice, const Scenario &scenario)
+{
+    voice.set_adaptive_antialiasing(scenario.adaptive);
+    voice.set_transit_mode(scenario.pitch_transit ? deepnote::DeepnoteVoiceBase::PITCH_TRANSIT
+                                                  : deepnote::DeepnoteVoiceBase::LINEAR_TRANSIT);
+}
+
+void configure_wavetable(deepnote::DeepnoteVoice &voice, const Scenario &scenario)
+{
+    configure_engine(voice, scenario);
+    voice.set_wavetable(&deepnote::SawWavetable::shared());
+}
+
+void configure_fixed(deepnote::FixedDeepnoteVoice &, const Scenario &) {}
+
+float process_engine(deepnote::DeepnoteVoice &voice, const Scenario &scenario)
+{
+    return process_voice(voice, nt::AnimationMultiplier(scenario.lfo_multiplier), nt::ControlPoint1(scenario.cp1),
+                         nt::ControlPoint2(scenario.cp2))
+        .get();
+}
+
+//  Largest spectral distance a variant may show on a scenario. Band-limited
+//  tables drop the top partials the BLEP kernels keep, which is most of the
+//  spectrum near Nyquist; elsewhere the variants sit under 1.7dB.
+double variant_bound(const Scenario &scenario)
+{
+    return std::string(scenario.name) == "near_nyquist" ? 4.5 : 2.0;
+}
+
+Scenario transposed(Scenario scenario, const float ratio)
+{
+    scenario.start *= ratio;
+    scenario.target *= ratio;
+    for(auto &retarget : scenario.retargets)
+    {
+        retarget.frequency *= ratio;
+    }
+    return scenario;
+}
+
+} // namespace
+
+TEST_CASE("Reference model")
+{
+    SUBCASE("The engine matches the reference")
+    {
+        for(const auto &scenario : deepnote::reference::canonical_scenarios())
+        {
+            deepnote::DeepnoteVoice voice;
+            const auto error = deepnote::reference::compare_renders(
+                deepnote::reference::render_reference(scenario),
+                deepnote::reference::render_voice(voice, scenario, &configure_engine, &process_engine));
+
+            INFO(std::string(scenario.name) << ": max " << error.max_abs << ", SNR " << error.snr_db
+                                            << "dB, spectral distance " << error.spectral_distance_db << "dB");
+            CHECK(error.snr_db > 40.0);
+            CHECK(error.spectral_distance_db < 0.5);
+        }
+    }
+
+    SUBCASE("Entry points render bit-identical output")
+    {
+        for(const auto &scenario : deepnote::reference::canonical_scenarios())
+        {
+            //  blocks flush denormals, which changes the last bits of near-silent
+            //  BLEP residuals, so the per-sample render does too
+            std::vector<float> per_sample;
+            {
+                const deepnote::ScopedFlushDenormals flush_denormals;
+                deepnote::DeepnoteVoice              voice;
+                per_sample = deepnote::reference::render_voice(voice, scenario, &configure_engine, &process_engine);
+            }
+
+            //  the same performance through process_voice_block(), with blocks
+            //  of up to 64 samples cut short at each retarget
+            deepnote::DeepnoteVoice block_voice;
+            std::vector<float>      blocks(scenario.samples);
+            size_t                  next{0};
+            size_t                  block_end{0};
+            const auto process_blocks = [&](deepnote::DeepnoteVoice &v, const Scenario &s) {
+                if(next == block_end)
+                {
+                    block_end = std::min<size_t>(next + 64, s.samples);
+                    for(const auto &retarget : s.retargets)
+                    {
+                        block_end = retarget.at_sample > next ? std::min(block_end, retarget.at_sample) : block_end;
+                    }
+                    process_voice_block(v, blocks.data() + next, block_end - next,
+                                        nt::AnimationMultiplier(s.lfo_multiplier), nt::ControlPoint1(s.cp1),
+                                        nt::ControlPoint2(s.cp2));
+                }
+                return blocks[next++];
+            };
+            deepnote::reference::render_voice(block_voice, scenario, &configure_engine, process_blocks);
+
+            INFO(std::string(scenario.name));
+            CHECK(deepnote::reference::render_hash(blocks) == deepnote::reference::render_hash(per_sample));
+        }
+    }
+
+    SUBCASE("Wavetable rendering stays spectrally close")
+    {
+        //  band-limited tables ring where BLEP kernels don't, so only the spectra are comparable
+        for(const auto &scenario : deepnote::reference::canonical_scenarios())
+        {
+            deepnote::DeepnoteVoice voice;
+            const auto wavetable =
+                deepnote::reference::render_voice(voice, scenario, &configure_wavetable, &process_engine);
+            const auto error =
+                deepnote::reference::compare_renders(deepnote::reference::render_reference(scenario), wavetable);
+
+            INFO(std::string(scenario.name) << ": spectral distance " << error.spectral_distance_db << "dB");
+            CHECK(error.spectral_distance_db < variant_bound(scenario));
+        }
+    }
+
+    SUBCASE("Fixed-point rendering stays spectrally close")
+    {
+        //  the fixed-point LFO follows the exact curve while the float one
+        //  accumulates rounding, so oscillator phases drift apart and only
+        //  spectra are comparable
+        for(auto scenario : deepnote::reference::canonical_scenarios())
+        {
+            if(scenario.pitch_transit)
+            {
+                continue;
+            }
+            scenario.adaptive = false;
+
+            deepnote::FixedDeepnoteVoice voice;
+            const auto process_fixed = [](deepnote::FixedDeepnoteVoice &v, const Scenario &s) {
+                return deepnote::fixed_output_to_float(
+                    process_voice(v, nt::FixedAnimationMultiplier(static_cast<int32_t>(s.lfo_multiplier * 65536)),
+                                  nt::FixedControlPoint1(deepnote::float_to_q31(s.cp1)),
+                                  nt::FixedControlPoint2(deepnote::float_to_q31(s.cp2))));
+            };
+            const auto fixed = deepnote::reference::render_voice(voice, scenario, &configure_fixed, process_fixed);
+            const auto error =
+                deepnote::reference::compare_renders(deepnote::reference::render_reference(scenario), fixed);
+
+            INFO(std::string(scenario.name) << ": spectral distance " << error.spectral_distance_db << "dB");
+            CHECK(error.spectral_distance_db < 1.5);
+        }
+    }
+
+    SUBCASE("Spectral distance rejects broken renders")
+    {
+        //  renders a variant could plausibly get wrong must fall outside the
+        //  bounds the variants are held to
+        for(const auto &scenario : deepnote::reference::canonical_scenarios())
+        {
+            const auto reference = deepnote::reference::render_reference(scenario);
+
+            const auto fifth = deepnote::reference::compare_renders(
+                reference, deepnote::reference::render_reference(transposed(scenario, 1.5f)));
+            const auto silence = deepnote::reference::compare_renders(reference, std::vector<float>(scenario.samples));
+
+            INFO(std::string(scenario.name) << ": up a fifth " << fifth.spectral_distance_db << "dB, silence "
+                                            << silence.spectral_distance_db << "dB");
+            CHECK(fifth.spectral_distance_db > variant_bound(scenario));
+            CHECK(silence.spectral_distance_db > variant_bound(scenario));
+
+            if(scenario.oscillators > 1)
+            {
+                auto half        = scenario;
+                half.oscillators = scenario.oscillators / 2;
+                const auto fewer =
+                    deepnote::reference::compare_renders(reference, deepnote::reference::render_reference(half));
+
+                INFO("half the oscillators " << fewer.spectral_distance_db << "dB");
+                CHECK(fewer.spectral_distance_db > variant_bound(scenario));
+            }
+        }
+    }
+
+    SUBCASE("Comparison metrics")
+    {
+        std::vector<float> signal(4096);
+        for(size_t i = 0; i < signal.size(); ++i)
+        {
+            signal[i] = std::sin(0.05f * i);
+        }
+
+        const auto identical = deepnote::reference::compare_renders(signal, signal);
+        CHECK(identical.max_abs == 0.0);
+        CHECK(std::isinf(identical.snr_db));
+        CHECK(identical.spectral_distance_db == 0.0);
+
+        //  an error of a hundredth of the amplitude is 40dB down
+        std::vector<float> scaled(signal);
+        for(auto &sample : scaled)
+        {
+            sample *= 1.01f;
+        }
+        const auto error = deepnote::reference::compare_renders(signal, scaled);
+        CHECK(error.snr_db == doctest::Approx(40.0).epsilon(0.01));
+        CHECK(error.max_abs == doctest::Approx(0.01).epsilon(0.01));
+        CHECK(error.spectral_distance_db < 0.1);
+
+        CHECK(deepnote::reference::render_hash(signal) == deepnote::reference::render_hash(signal));
+        CHECK(deepnote::reference::render_hash(signal) != deepnote::reference::render_hash(scaled));
+    }
+}
@@ -0,0 +1,259 @@
+/**
+ * @file golden.hpp
+ * @brief Canonical render scenarios and output comparison for engine variants
+ *
+ * Each Scenario describes a voice configuration and a short performance,
+ * including retargets. render_reference() plays it on ReferenceVoice and
+ * render_voice() on any voice with the init_voice()/process_voice() API, so
+ * float, fixed-point, wavetable or block paths can be rendered alike.
+ * compare_renders() then reports how far a variant is from the reference,
+ * and render_hash() identifies renders that must match bit for bit, such as
+ * the same engine driven through different entry points.
+ */
+
+#pragma once
+
+#include "referencevoice.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace deepnote
+{
+namespace reference
+{
+
+struct Retarget
+{
+    size_t at_sample;
+    float  frequency;
+};
+
+struct Scenario
+{
+    const char           *name;
+    size_t                oscillators;
+    float                 start;
+    float                 target;
+    float                 lfo_frequency;
+    float                 detune;
+    float                 cp1;
+    float                 cp2;
+    float                 lfo_multiplier;
+    size_t                samples;
+    bool                  adaptive;
+    bool                  pitch_transit;
+    std::vector<Retarget> retargets;
+};
+
+constexpr float SAMPLE_RATE = 48000.f;
+
+inline const std::vector<Scenario> &canonical_scenarios()
+{
+    static const std::vector<Scenario> scenarios = {
+        {"rise_4osc", 4, 200.f, 1200.f, 1.f, 2.5f, 0.08f, 0.5f, 1.f, 60000, true, false, {}},
+        {"fall_16osc", 16, 3000.f, 150.f, 2.f, 4.f, 0.25f, 0.75f, 1.f, 36000, true, false, {}},
+        {"single_low", 1, 20.f, 60.f, 4.f, 0.f, 0.f, 1.f, 1.f, 24000, true, false, {}},
+        {"near_nyquist", 8, 4000.f, 18000.f, 2.f, 30.f, 0.1f, 0.9f, 1.f, 36000, true, false, {}},
+        {"polyblep_only", 8, 100.f, 9000.f, 1.f, 10.f, 0.08f, 0.5f, 1.f, 60000, false, false, {}},
+        {"fast_animation", 6, 440.f, 110.f, 1.f, 1.f, 0.5f, 0.5f, 8.f, 12000, true, false, {}},
+        {"retarget_mid_transit", 8, 200.f, 2000.f, 1.f, 2.5f, 0.08f, 0.5f, 1.f, 96000, true, false,
+         {{20000, 500.f}, {60000, 5000.f}}},
+        {"pitch_transit", 8, 55.f, 3520.f, 1.f, 1.5f, 0.08f, 0.5f, 1.f, 60000, true, true, {{50000, 110.f}}},
+    };
+    return scenarios;
+}
+
+inline std::vector<float> render_reference(const Scenario &scenario)
+{
+    ReferenceVoice voice(scenario.oscillators, scenario.start, SAMPLE_RATE, scenario.lfo_frequency, scenario.detune);
+    voice.adaptive      = scenario.adaptive;
+    voice.pitch_transit = scenario.pitch_transit;
+    voice.set_target(scenario.target);
+
+    std::vector<float> out(scenario.samples);
+    size_t             next = 0;
+    for(size_t i = 0; i < out.size(); ++i)
+    {
+        if(next < scenario.retargets.size() && scenario.retargets[next].at_sample == i)
+        {
+            voice.set_target(scenario.retargets[next++].frequency);
+        }
+        out[i] = voice.process(scenario.lfo_multiplier, scenario.cp1, scenario.cp2);
+    }
+    return out;
+}
+
+/**
+ * @brief Render a scenario on an engine voice
+ * @param voice Voice to render on, e.g. DeepnoteVoice
+ * @param scenario Scenario to play
+ * @param configure Called as configure(voice, scenario) once the voice is initialised
+ * @param process Called as process(voice, scenario) for each sample, returning a float
+ */
+template <typename Voice, typename Configure, typename Process>
+std::vector<float> render_voice(Voice &voice, const Scenario &scenario, Configure &&configure, Process &&process)
+{
+    init_voice(voice, scenario.oscillators, nt::OscillatorFrequency(scenario.start), nt::SampleRate(SAMPLE_RATE),
+               nt::OscillatorFrequency(scenario.lfo_frequency), nt::DetuneHz(scenario.detune));
+    configure(voice, scenario);
+    voice.set_target_frequency(nt::OscillatorFrequency(scenario.target));
+
+    std::vector<float> out(scenario.samples);
+    size_t             next = 0;
+    for(size_t i = 0; i < out.size(); ++i)
+    {
+        if(next < scenario.retargets.size() && scenario.retargets[next].at_sample == i)
+        {
+            voice.set_target_frequency(nt::OscillatorFrequency(scenario.retargets[next++].frequency));
+        }
+        out[i] = process(voice, scenario);
+    }
+    return out;
+}
+
+/**
+ * @brief 64-bit FNV-1a over the bit patterns of a render
+ */
+inline uint64_t render_hash(const std::vector<float> &render)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for(const float sample : render)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &sample, sizeof(bits));
+        for(int byte = 0; byte < 4; ++byte)
+        {
+            hash = (hash ^ ((bits >> (8 * byte)) & 0xff)) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+struct RenderError
+{
+    double max_abs;
+    double rms;
+    //  signal to error power ratio, infinite for identical renders
+    double snr_db;
+    //  RMS of the difference in dB between magnitude spectra, over the bins of
+    //  each frame above the floor in either render
+    double spectral_distance_db;
+};
+
+namespace detail
+{
+
+constexpr double PI = 3.14159265358979323846;
+
+inline void fft(std::vector<std::complex<double>> &x)
+{
+    const size_t n = x.size();
+    for(size_t i = 1, j = 0; i < n; ++i)
+    {
+        size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if(i < j)
+        {
+            std::swap(x[i], x[j]);
+        }
+    }
+    for(size_t length = 2; length <= n; length <<= 1)
+    {
+        const std::complex<double> step = std::polar(1.0, -2.0 * PI / length);
+        for(size_t i = 0; i < n; i += length)
+        {
+            std::complex<double> w(1.0);
+            for(size_t k = 0; k < length / 2; ++k)
+            {
+                const auto even = x[i + k];
+                const auto odd  = x[i + k + length / 2] * w;
+                x[i + k]              = even + odd;
+                x[i + k + length / 2] = even - odd;
+                w *= step;
+            }
+        }
+    }
+}
+
+//  Hann-windowed magnitude spectrum of frame_size samples from start, in dB
+//  relative to a full-scale frame and floored at -floor_db
+inline std::vector<double> spectrum_db(const std::vector<float> &render, const size_t start, const size_t frame_size,
+                                       const double floor_db)
+{
+    std::vector<std::complex<double>> frame(frame_size);
+    for(size_t i = 0; i < frame_size; ++i)
+    {
+        const double window = 0.5 - 0.5 * std::cos(2.0 * PI * i / frame_size);
+        frame[i]            = render[start + i] * window;
+    }
+    fft(frame);
+
+    std::vector<double> db(frame_size / 2);
+    for(size_t bin = 0; bin < db.size(); ++bin)
+    {
+        db[bin] = std::max(-floor_db, 20.0 * std::log10(std::abs(frame[bin]) / frame_size + 1e-12));
+    }
+    return db;
+}
+
+} // namespace detail
+
+/**
+ * @brief Compare a candidate render against a reference render
+ * @param reference Render from the reference model
+ * @param candidate Render from the variant under test
+ * @param frame_size FFT size for the spectral distance, a power of two
+ * @param floor_db Spectral levels below this many dB under full scale count as
+ *        equal, and bins below it in both renders are left out, so the
+ *        distance measures the partials rather than the noise between them
+ */
+inline RenderError compare_renders(const std::vector<float> &reference, const std::vector<float> &candidate,
+                                   const size_t frame_size = 1024, const double floor_db = 40.0)
+{
+    const size_t count = std::min(reference.size(), candidate.size());
+
+    double max_abs{0.0};
+    double signal{0.0};
+    double error{0.0};
+    for(size_t i = 0; i < count; ++i)
+    {
+        const double difference = static_cast<double>(candidate[i]) - reference[i];
+        max_abs                  = std::max(max_abs, std::abs(difference));
+        signal += static_cast<double>(reference[i]) * reference[i];
+        error += difference * difference;
+    }
+
+    double spectral{0.0};
+    size_t bins{0};
+    for(size_t start = 0; start + frame_size <= count; start += frame_size)
+    {
+        const auto a = detail::spectrum_db(reference, start, frame_size, floor_db);
+        const auto b = detail::spectrum_db(candidate, start, frame_size, floor_db);
+        for(size_t bin = 0; bin < a.size(); ++bin)
+        {
+            if(a[bin] > -floor_db || b[bin] > -floor_db)
+            {
+                spectral += (a[bin] - b[bin]) * (a[bin] - b[bin]);
+                ++bins;
+            }
+        }
+    }
+
+    RenderError result;
+    result.max_abs              = max_abs;
+    result.rms                  = count > 0 ? std::sqrt(error / count) : 0.0;
+    result.snr_db               = error > 0.0 ? 10.0 * std::log10(signal / error) : INFINITY;
+    result.spectral_distance_db = bins > 0 ? std::sqrt(spectral / bins) : 0.0;
+    return result;
+}
+
+} // namespace reference
+} // namespace deepnote
@@ -0,0 +1,220 @@
+/**
+ * @file referencevoice.hpp
+ * @brief Deliberately simple reference model of process_voice()
+ *
+ * ReferenceVoice restates what a DeepnoteVoice does per sample as plainly as
+ * possible: one function, written in the order the behaviour is described,
+ * with no caching, fast paths, precomputed increments, templates or shared
+ * library code. It uses float like the engine, so the two agree to within
+ * rounding rather than drifting apart, and it is the yardstick optimised
+ * paths are measured against. Change it only when the intended behaviour of
+ * the voice changes.
+ *
+ * Covers linear and pitch transits, symmetric detune and the naive, PolyBLEP
+ * and 4-point B-spline kernels with adaptive selection. Wavetable rendering
+ * is a variant to be compared against this model, not part of it.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace deepnote
+{
+namespace reference
+{
+
+struct ReferenceVoice
+{
+    enum State
+    {
+        PENDING,
+        IN_TRANSIT,
+        AT_TARGET
+    };
+
+    enum Kernel
+    {
+        NAIVE,
+        POLYBLEP,
+        POLYBLEP4
+    };
+
+    ReferenceVoice(const size_t oscillators, const float start, const float sample_rate, const float lfo_frequency,
+                   const float detune)
+        : sample_rate(sample_rate)
+        , lfo_frequency(lfo_frequency)
+        , start(start)
+        , target(start)
+        , current(start)
+        , phases(oscillators, 0.f)
+        , kernels(oscillators, POLYBLEP)
+        , detunes(oscillators, 0.f)
+    {
+        //  oscillators sit at -n * detune ... -detune, +detune ... +n * detune, skipping 0
+        const int half = static_cast<int>(oscillators / 2);
+        for(size_t i = 0; i < oscillators && oscillators > 1; ++i)
+        {
+            const int step = static_cast<int>(i) - half + (static_cast<int>(i) >= half ? 1 : 0);
+            detunes[i]     = step * detune;
+        }
+    }
+
+    void set_target(const float frequency)
+    {
+        start  = current;
+        target = frequency;
+        state  = PENDING;
+    }
+
+    float process(const float lfo_multiplier, const float cp1, const float cp2)
+    {
+        if(state == PENDING)
+        {
+            lfo_phase = 0.f;
+            state     = IN_TRANSIT;
+        }
+
+        if(state == AT_TARGET)
+        {
+            current = target;
+        }
+        else
+        {
+            //  a rising ramp from 0 to 1 over one LFO cycle
+            const float t = lfo_phase;
+            lfo_phase += lfo_frequency * lfo_multiplier / sample_rate;
+            if(lfo_phase > 1.f)
+            {
+                lfo_phase -= 1.f;
+            }
+
+            //  cubic Bezier from 0 to 1 with control points cp1 and cp2
+            const float u = 1.f - t;
+            const float s = 3.f * u * u * t * cp1 + 3.f * u * t * t * cp2 + t * t * t;
+
+            float frequency;
+            if(pitch_transit)
+            {
+                const float low  = std::max(start, 0.5f);
+                const float high = std::max(target, 0.5f);
+                frequency        = low * std::exp2(s * std::log2(high / low));
+            }
+            else
+            {
+                frequency = start + s * (target - start);
+            }
+
+            const float low  = std::min(start, target);
+            const float high = std::max(start, target);
+            if(frequency < low || frequency > high || std::fabs(frequency - target) <= 1.f)
+            {
+                state = AT_TARGET;
+            }
+            current = state == AT_TARGET ? target : std::min(std::max(frequency, low), high);
+        }
+
+        return process_oscillators();
+    }
+
+    float process_oscillators()
+    {
+        //  kernels are chosen every 32 samples from each oscillator's frequency
+        const bool select_kernels = (kernel_countdown == 0);
+        kernel_countdown          = (select_kernels ? 32 : kernel_countdown) - 1;
+
+        float sum{0.f};
+        for(size_t i = 0; i < phases.size(); ++i)
+        {
+            const float inc = (current + detunes[i]) / sample_rate;
+            const float dt  = std::fabs(inc);
+            if(select_kernels)
+            {
+                kernels[i] = !adaptive ? POLYBLEP : dt < 1.f / 512.f ? NAIVE : dt < 1.f / 8.f ? POLYBLEP : POLYBLEP4;
+            }
+
+            const float phase = phases[i];
+            float       out   = 1.f - 2.f * phase;
+            if(kernels[i] == POLYBLEP)
+            {
+                out += polyblep(phase, dt);
+            }
+            else if(kernels[i] == POLYBLEP4)
+            {
+                out += polyblep4(phase, dt);
+            }
+            sum += 0.5f * out;
+
+            phases[i] += inc;
+            if(phases[i] > 1.f)
+            {
+                phases[i] -= 1.f;
+            }
+            else if(phases[i] < 0.f)
+            {
+                phases[i] += 1.f;
+            }
+        }
+        return sum;
+    }
+
+    bool  adaptive{true};
+    bool  pitch_transit{false};
+    State state{PENDING};
+
+  private:
+    static float polyblep(float t, const float dt)
+    {
+        if(t < dt)
+        {
+            t /= dt;
+            return 2.f * t - t * t - 1.f;
+        }
+        if(t > 1.f - dt)
+        {
+            t = (t - 1.f) / dt;
+            return t * t + 2.f * t + 1.f;
+        }
+        return 0.f;
+    }
+
+    //  twice the integral of the cubic B-spline beyond y samples from a step
+    static float bspline_tail(const float y)
+    {
+        if(y < 1.f)
+        {
+            return (12.f - 16.f * y + 8.f * y * y * y - 3.f * y * y * y * y) / 12.f;
+        }
+        return (2.f - y) * (2.f - y) * (2.f - y) * (2.f - y) / 12.f;
+    }
+
+    static float polyblep4(const float t, const float dt)
+    {
+        float residual{0.f};
+        if(t < 2.f * dt)
+        {
+            residual -= bspline_tail(t / dt);
+        }
+        if(t > 1.f - 2.f * dt)
+        {
+            residual += bspline_tail((1.f - t) / dt);
+        }
+        return residual;
+    }
+
+    float               sample_rate;
+    float               lfo_frequency;
+    float               lfo_phase{0.f};
+    float               start;
+    float               target;
+    float               current;
+    size_t              kernel_countdown{0};
+    std::vector<float>  phases;
+    std::vector<Kernel> kernels;
+    std::vector<float>  detunes;
+};
+
+} // namespace reference
+} // namespace deepnote
@@ -0,0 +1,209 @@
+#include "ensemble/ensemble.hpp"
+#include "ensemble/rendergraph.hpp"
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+namespace
+{
+
+void init_test_voice(deepnote::DeepnoteVoice &voice, const float start, const float target)
+{
+    init_voice(voice, 4, nt::OscillatorFrequency(start), nt::SampleRate(48000.f), nt::OscillatorFrequency(1.f));
+    voice.set_target_frequency(nt::OscillatorFrequency(target));
+}
+
+struct CountingTap
+{
+    size_t samples{0};
+    float  last{0.f};
+
+    void operator()(const float *block, const size_t count)
+    {
+        samples += count;
+        last = block[count - 1];
+    }
+};
+
+struct Constant
+{
+    float value;
+
+    void operator()(const deepnote::BlockParameters &, const deepnote::NodeInputs &inputs, float *out,
+                    const size_t count)
+    {
+        std::fill(out, out + count, value);
+        for(size_t input = 0; input < inputs.count; ++input)
+        {
+            for(size_t i = 0; i < count; ++i)
+            {
+                out[i] += inputs.buffers[input][i];
+            }
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE("RenderGraph")
+{
+    const deepnote::BlockParameters parameters{nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f),
+                                               nt::ControlPoint2(0.5f)};
+
+    SUBCASE("Voices into a mixer match process_ensemble_block")
+    {
+        std::array<deepnote::DeepnoteVoice, 3> reference;
+        std::array<deepnote::DeepnoteVoice, 3> voices;
+        for(size_t i = 0; i < voices.size(); ++i)
+        {
+            init_test_voice(reference[i], 100.f * (i + 1), 1000.f + 200.f * i);
+            init_test_voice(voices[i], 100.f * (i + 1), 1000.f + 200.f * i);
+        }
+
+        std::vector<float> expected(300);
+        std::vector<float> actual(expected.size());
+        process_ensemble_block(reference.begin(), reference.end(), expected.data(), expected.size(),
+                               parameters.lfo_multiplier, parameters.cp1, parameters.cp2);
+
+        deepnote::RenderGraph<8, 8, 4> graph;
+        graph.set_parameters(parameters);
+        const auto mix = graph.add_mixer({graph.add_voice(voices[0]), graph.add_voice(voices[1]),
+                                          graph.add_voice(voices[2])});
+        graph.add_sink(mix, actual.data());
+        graph.process(actual.size());
+
+        for(size_t i = 0; i < expected.size(); ++i)
+        {
+            REQUIRE(actual[i] == doctest::Approx(expected[i]));
+        }
+    }
+
+    SUBCASE("Mixer gains")
+    {
+        Constant one{1.f};
+        Constant two{2.f};
+
+        std::vector<float>             out(16);
+        deepnote::RenderGraph<8, 8, 4> graph;
+        const auto mix = graph.add_mixer({graph.add_node(one, {}), graph.add_node(two, {})});
+        graph.add_sink(mix, out.data());
+        graph.set_input_gain(mix, 1, 0.25f);
+        graph.process(out.size());
+        CHECK(out[0] == doctest::Approx(1.5f));
+        CHECK(out[15] == doctest::Approx(1.5f));
+
+        CHECK_THROWS_AS(graph.set_input_gain(mix, 2, 1.f), std::invalid_argument);
+    }
+
+    SUBCASE("Taps see the block and pass it through")
+    {
+        Constant    source{0.5f};
+        CountingTap tap;
+
+        std::vector<float>             out(100);
+        deepnote::RenderGraph<8, 8, 4> graph;
+        graph.add_sink(graph.add_tap(graph.add_node(source, {}), tap), out.data());
+        graph.process(out.size());
+
+        CHECK(tap.samples == out.size());
+        CHECK(tap.last == 0.5f);
+        CHECK(out[99] == 0.5f);
+    }
+
+    SUBCASE("Nodes that don't reach a sink are not evaluated")
+    {
+        deepnote::DeepnoteVoice used;
+        deepnote::DeepnoteVoice unused;
+        init_test_voice(used, 100.f, 1000.f);
+        init_test_voice(unused, 100.f, 1000.f);
+        CountingTap tap;
+
+        std::vector<float>             out(64);
+        deepnote::RenderGraph<8, 8, 4> graph;
+        const auto used_node   = graph.add_voice(used);
+        const auto unused_node = graph.add_voice(unused);
+        const auto unused_tap  = graph.add_tap(unused_node, tap);
+        graph.add_sink(used_node, out.data());
+
+        CHECK(graph.is_active(used_node));
+        CHECK_FALSE(graph.is_active(unused_node));
+        CHECK_FALSE(graph.is_active(unused_tap));
+
+        graph.process(out.size());
+        CHECK(used.get_current_frequency().get() > 100.f);
+        CHECK(unused.get_current_frequency().get() == 100.f);
+        CHECK(tap.samples == 0);
+    }
+
+    SUBCASE("Buffers are reused once their last consumer has run")
+    {
+        //  a long chain needs two buffers however long it is
+        std::array<Constant, 20>        stages{};
+        std::vector<float>              out(200);
+        deepnote::RenderGraph<32, 32, 2> graph;
+
+        auto previous = graph.add_node(stages[0], {});
+        for(size_t i = 1; i < stages.size(); ++i)
+        {
+            stages[i].value = 1.f;
+            previous        = graph.add_node(stages[i], {previous});
+        }
+        graph.add_sink(previous, out.data());
+
+        CHECK(graph.get_peak_buffers() == 2);
+        graph.process(out.size());
+        CHECK(out[0] == 19.f);
+        CHECK(out[199] == 19.f);
+    }
+
+    SUBCASE("Fan-out keeps a block until every consumer has read it")
+    {
+        Constant source{3.f};
+        Constant doubled{0.f};
+
+        std::vector<float>             left(8);
+        std::vector<float>             right(8);
+        deepnote::RenderGraph<8, 8, 4> graph;
+        const auto node  = graph.add_node(source, {});
+        const auto twice = graph.add_node(doubled, {node, node});
+        graph.add_sink(twice, left.data());
+        graph.add_sink(node, right.data());
+        graph.process(left.size());
+
+        CHECK(left[7] == 6.f);
+        CHECK(right[7] == 3.f);
+    }
+
+    SUBCASE("A pool too small for the graph is rejected")
+    {
+        Constant                       source{1.f};
+        std::vector<float>             out(8);
+        deepnote::RenderGraph<8, 8, 2> graph;
+        const auto mix = graph.add_mixer(
+            {graph.add_node(source, {}), graph.add_node(source, {}), graph.add_node(source, {})});
+        graph.add_sink(mix, out.data());
+
+        CHECK_THROWS_AS(graph.process(out.size()), std::invalid_argument);
+    }
+
+    SUBCASE("Invalid topology")
+    {
+        Constant                       source{1.f};
+        std::vector<float>             out(8);
+        deepnote::RenderGraph<4, 4, 2> graph;
+        CHECK_THROWS_AS(graph.add_mixer({0}), std::invalid_argument);
+
+        const auto sink = graph.add_sink(graph.add_node(source, {}), out.data());
+        CHECK_THROWS_AS(graph.add_node(source, {sink}), std::invalid_argument);
+        CHECK_THROWS_AS(graph.set_sink_buffer(0, out.data()), std::invalid_argument);
+
+        //  a sink without a buffer would silently become an ordinary node
+        CHECK_THROWS_AS(graph.add_sink(0, nullptr), std::invalid_argument);
+        CHECK(graph.get_node_count() == 2);
+        CHECK_THROWS_AS(graph.set_sink_buffer(sink, nullptr), std::invalid_argument);
+        graph.set_sink_buffer(sink, out.data());
+        graph.process(out.size());
+        CHECK(out[0] == 1.f);
+    }
+}
@@ -0,0 +1,159 @@
+#include "Synthesis/oscillator.h"
+#include "analysis/spectrum.hpp"
+#include "oscillators/sawoscillator.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <array>
+#include <cmath>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+using deepnote::analysis::magnitude_at;
+
+namespace
+{
+std::vector<float> render(deepnote::SawOscillator::Kernel kernel, const float freq, const float sample_rate,
+                          const size_t count)
+{
+    deepnote::SawOscillator osc;
+    osc.init(sample_rate);
+    osc.set_freq(freq);
+    osc.set_kernel(kernel);
+
+    std::vector<float> out(count);
+    for(auto &sample : out)
+    {
+        sample = osc.process();
+    }
+    return out;
+}
+} // namespace
+
+TEST_CASE("SawOscillator::select_kernel")
+{
+    using deepnote::SawOscillator;
+
+    CHECK(SawOscillator::select_kernel(0.f) == SawOscillator::NAIVE);
+    CHECK(SawOscillator::select_kernel(20.f / 48000.f) == SawOscillator::NAIVE);
+    CHECK(SawOscillator::select_kernel(440.f / 48000.f) == SawOscillator::POLYBLEP);
+    CHECK(SawOscillator::select_kernel(8000.f / 48000.f) == SawOscillator::POLYBLEP4);
+
+    //  negative frequencies are classified by magnitude
+    CHECK(SawOscillator::select_kernel(-440.f / 48000.f) == SawOscillator::POLYBLEP);
+}
+
+TEST_CASE("SawOscillator kernels")
+{
+    const float sample_rate = 48000.f;
+
+    SUBCASE("POLYBLEP matches daisysp::Oscillator WAVE_POLYBLEP_SAW")
+    {
+        daisysp::Oscillator reference;
+        reference.Init(sample_rate);
+        reference.SetWaveform(daisysp::Oscillator::WAVE_POLYBLEP_SAW);
+        reference.SetFreq(441.f);
+
+        const auto out = render(deepnote::SawOscillator::POLYBLEP, 441.f, sample_rate, 4800);
+        for(const auto sample : out)
+        {
+            CHECK(sample == doctest::Approx(reference.Process()).epsilon(1e-3));
+        }
+    }
+
+    SUBCASE("NAIVE is a falling ramp")
+    {
+        const auto out = render(deepnote::SawOscillator::NAIVE, 480.f, sample_rate, 50);
+        for(size_t i = 0; i < out.size(); ++i)
+        {
+            const float phase = std::fmod(i * 0.01f, 1.f);
+            CHECK(out[i] == doctest::Approx(0.5f - phase).epsilon(1e-3));
+        }
+    }
+
+    SUBCASE("All kernels stay bounded up to Nyquist")
+    {
+        for(const auto kernel : {deepnote::SawOscillator::NAIVE, deepnote::SawOscillator::POLYBLEP,
+                                 deepnote::SawOscillator::POLYBLEP4})
+        {
+            for(const float freq : {1.f, 100.f, 4000.f, 12000.f, 23000.f, -3000.f})
+            {
+                for(const auto sample : render(kernel, freq, sample_rate, 2048))
+                {
+                    REQUIRE(std::isfinite(sample));
+                    REQUIRE(std::abs(sample) <= 0.75f);
+                }
+            }
+        }
+    }
+
+    SUBCASE("POLYBLEP4 aliases less than POLYBLEP near Nyquist")
+    {
+        //  the 7th harmonic of 7kHz folds back to 1kHz
+        const float freq  = 7000.f;
+        const float alias = sample_rate - 7.f * freq;
+
+        const auto polyblep  = render(deepnote::SawOscillator::POLYBLEP, freq, sample_rate, 8192);
+        const auto polyblep4 = render(deepnote::SawOscillator::POLYBLEP4, freq, sample_rate, 8192);
+
+        CHECK(magnitude_at(polyblep4, alias, sample_rate) < 0.5f * magnitude_at(polyblep, alias, sample_rate));
+    }
+}
+
+TEST_CASE("DeepnoteVoice adaptive anti-aliasing")
+{
+    const nt::SampleRate sample_rate{48000.f};
+
+    SUBCASE("Enabled by default")
+    {
+        deepnote::DeepnoteVoice voice;
+        CHECK(voice.is_adaptive_antialiasing());
+    }
+
+    SUBCASE("Matches fixed PolyBLEP in the mid range")
+    {
+        deepnote::DeepnoteVoice adaptive;
+        deepnote::DeepnoteVoice fixed;
+        init_voice(adaptive, 3, nt::OscillatorFrequency(440.f), sample_rate, nt::OscillatorFrequency(1.f));
+        init_voice(fixed, 3, nt::OscillatorFrequency(440.f), sample_rate, nt::OscillatorFrequency(1.f));
+        fixed.set_adaptive_antialiasing(false);
+
+        adaptive.set_target_frequency(nt::OscillatorFrequency(880.f));
+        fixed.set_target_frequency(nt::OscillatorFrequency(880.f));
+
+        for(int i = 0; i < 4800; ++i)
+        {
+            const auto a =
+                process_voice(adaptive, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.1f), nt::ControlPoint2(0.9f));
+            const auto f =
+                process_voice(fixed, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.1f), nt::ControlPoint2(0.9f));
+            REQUIRE(a.get() == f.get());
+        }
+    }
+
+    SUBCASE("Sweeps across every kernel")
+    {
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 4, nt::OscillatorFrequency(20.f), sample_rate, nt::OscillatorFrequency(4.f));
+        voice.set_target_frequency(nt::OscillatorFrequency(12000.f));
+
+        std::array<bool, 3> selected{};
+        for(int i = 0; i < 24000; ++i)
+        {
+            const auto out =
+                process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.1f), nt::ControlPoint2(0.9f));
+            REQUIRE(std::isfinite(out.get()));
+            REQUIRE(std::abs(out.get()) <= 3.f);
+
+            for(size_t osc = 0; osc < voice.get_oscillator_count(); ++osc)
+            {
+                const float phase_inc = voice.get_oscillator_frequency(osc).get() / sample_rate.get();
+                selected[deepnote::SawOscillator::select_kernel(phase_inc)] = true;
+            }
+        }
+        CHECK(voice.is_at_target());
+        CHECK(selected[deepnote::SawOscillator::NAIVE]);
+        CHECK(selected[deepnote::SawOscillator::POLYBLEP]);
+        CHECK(selected[deepnote::SawOscillator::POLYBLEP4]);
+    }
+}
@@ -1,5 +1,6 @@
 #include "ranges/scaler.hpp"
 #include <doctest/doctest.h>
+#include <vector>
 
 namespace nt = deepnote::nt;
 
@@ -41,3 +42,26 @@ TEST_CASE("Scaler")
         CHECK(scaler(0) == -5);
     }
 }
+
+TEST_CASE("Scaler buffers")
+{
+    nt::InputRange   input(deepnote::Range(nt::RangeLow(-5.f), nt::RangeHigh(5.f)));
+    nt::OutputRange  output(deepnote::Range(nt::RangeLow(40.f), nt::RangeHigh(1200.f)));
+    deepnote::Scaler scaler(input, output);
+
+    std::vector<float> values(101);
+    for(size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = -5.f + 0.1f * i;
+    }
+
+    std::vector<float> out(values.size());
+    scaler.scale(values.data(), out.data(), values.size());
+    for(size_t i = 0; i < values.size(); ++i)
+    {
+        REQUIRE(out[i] == scaler(values[i]));
+    }
+
+    scaler.scale(values.data(), values.data(), values.size());
+    CHECK(values == out);
+}
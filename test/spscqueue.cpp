@@ -0,0 +1,85 @@
+#include "util/spscqueue.hpp"
+#include <doctest/doctest.h>
+#include <thread>
+
+TEST_CASE("SpscQueue")
+{
+    SUBCASE("Values come out in order")
+    {
+        deepnote::SpscQueue<int, 8> queue;
+        CHECK(queue.empty());
+        CHECK(deepnote::SpscQueue<int, 8>::capacity() == 8);
+
+        int value{0};
+        CHECK(!queue.try_pop(value));
+        for(int round = 0; round < 5; ++round)
+        {
+            for(int i = 0; i < 5; ++i)
+            {
+                REQUIRE(queue.try_push(round * 10 + i));
+            }
+            CHECK(queue.size() == 5);
+            for(int i = 0; i < 5; ++i)
+            {
+                REQUIRE(queue.try_pop(value));
+                CHECK(value == round * 10 + i);
+            }
+            CHECK(queue.empty());
+        }
+    }
+
+    SUBCASE("A full queue drops and counts values")
+    {
+        deepnote::SpscQueue<int, 4> queue;
+        for(int i = 0; i < 4; ++i)
+        {
+            REQUIRE(queue.try_push(i));
+        }
+        CHECK(!queue.try_push(4));
+        CHECK(!queue.try_push(5));
+        CHECK(queue.get_dropped() == 2);
+        CHECK(queue.size() == 4);
+
+        int value{0};
+        REQUIRE(queue.try_pop(value));
+        CHECK(value == 0);
+        CHECK(queue.try_push(6));
+        for(const int expected : {1, 2, 3, 6})
+        {
+            REQUIRE(queue.try_pop(value));
+            CHECK(value == expected);
+        }
+    }
+
+    SUBCASE("Producer and consumer threads")
+    {
+        deepnote::SpscQueue<uint64_t, 64> queue;
+        const uint64_t                    count = 200000;
+
+        std::thread producer([&] {
+            for(uint64_t i = 0; i < count;)
+            {
+                if(queue.try_push(i))
+                {
+                    ++i;
+                }
+            }
+        });
+
+        uint64_t expected{0};
+        bool     in_order{true};
+        while(expected < count)
+        {
+            uint64_t value;
+            if(queue.try_pop(value))
+            {
+                in_order = in_order && (value == expected);
+                ++expected;
+            }
+        }
+        producer.join();
+
+        CHECK(in_order);
+        CHECK(queue.empty());
+    }
+}
@@ -0,0 +1,152 @@
+#include "ensemble/stateevents.hpp"
+#include "ensemble/voicepool.hpp"
+#include "fixedpoint/fixedvoice.hpp"
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+namespace
+{
+const nt::SampleRate sample_rate{48000};
+
+std::vector<deepnote::StateEvent> drain(deepnote::StateEventQueue<> &events)
+{
+    std::vector<deepnote::StateEvent> drained;
+    deepnote::StateEvent              event;
+    while(events.try_pop(event))
+    {
+        drained.push_back(event);
+    }
+    return drained;
+}
+} // namespace
+
+TEST_CASE("StateEventTrace")
+{
+    SUBCASE("Posts each state change with its sample position")
+    {
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 4, nt::OscillatorFrequency(200.f), sample_rate, nt::OscillatorFrequency(10.f));
+        voice.set_target_frequency(nt::OscillatorFrequency(400.f));
+
+        deepnote::StateEventQueue<> events;
+        const auto                  trace = deepnote::make_state_event_trace(events, 7, 1000);
+
+        uint64_t reached_target{0};
+        for(uint64_t i = 0; i < 9600; ++i)
+        {
+            const bool was_at_target = voice.is_at_target();
+            process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f),
+                          trace);
+            if(!was_at_target && voice.is_at_target())
+            {
+                reached_target = 1000 + i;
+            }
+        }
+        CHECK(trace.get_sample_position() == 1000 + 9600);
+        REQUIRE(reached_target > 0);
+
+        const auto posted = drain(events);
+        REQUIRE(posted.size() == 2);
+        CHECK(posted[0].voice_id == 7);
+        CHECK(posted[0].state == deepnote::DeepnoteVoiceBase::IN_TRANSIT_TO_TARGET);
+        CHECK(posted[0].sample_position == 1000);
+        CHECK(posted[1].voice_id == 7);
+        CHECK(posted[1].state == deepnote::DeepnoteVoiceBase::AT_TARGET);
+        CHECK(posted[1].sample_position == reached_target);
+    }
+
+    SUBCASE("Blocks and the fixed-point voice post the same events")
+    {
+        deepnote::DeepnoteVoice      voice;
+        deepnote::FixedDeepnoteVoice fixed_voice;
+        init_voice(voice, 4, nt::OscillatorFrequency(300.f), sample_rate, nt::OscillatorFrequency(20.f));
+        init_voice(fixed_voice, 4, nt::OscillatorFrequency(300.f), sample_rate, nt::OscillatorFrequency(20.f));
+        voice.set_target_frequency(nt::OscillatorFrequency(100.f));
+        fixed_voice.set_target_frequency(nt::OscillatorFrequency(100.f));
+
+        deepnote::StateEventQueue<> events;
+        deepnote::StateEventQueue<> fixed_events;
+        float                       out[64];
+        for(uint64_t block = 0; block < 75; ++block)
+        {
+            process_voice_block(voice, out, 64, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.f),
+                                nt::ControlPoint2(1.f), deepnote::make_state_event_trace(events, 1, block * 64));
+        }
+        const auto fixed_trace = deepnote::make_state_event_trace(fixed_events, 1, 0);
+        for(int i = 0; i < 75 * 64; ++i)
+        {
+            process_voice(fixed_voice, nt::FixedAnimationMultiplier(1 << 16), nt::FixedControlPoint1(0),
+                          nt::FixedControlPoint2(INT32_MAX), fixed_trace);
+        }
+
+        const auto posted       = drain(events);
+        const auto fixed_posted = drain(fixed_events);
+        REQUIRE(posted.size() == 2);
+        REQUIRE(fixed_posted.size() == 2);
+        CHECK(posted[1].state == deepnote::DeepnoteVoiceBase::AT_TARGET);
+        CHECK(fixed_posted[1].state == deepnote::DeepnoteVoiceBase::AT_TARGET);
+        CHECK(std::abs(static_cast<int64_t>(posted[1].sample_position - fixed_posted[1].sample_position)) < 16);
+    }
+
+    SUBCASE("Voices at target post nothing")
+    {
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 4, nt::OscillatorFrequency(200.f), sample_rate, nt::OscillatorFrequency(10.f));
+
+        deepnote::StateEventQueue<> events;
+        float                       out[256];
+        process_voice_block(voice, out, 256, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f),
+                            nt::ControlPoint2(0.5f), deepnote::make_state_event_trace(events, 0, 0));
+        drain(events);
+
+        process_voice_block(voice, out, 256, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f),
+                            nt::ControlPoint2(0.5f), deepnote::make_state_event_trace(events, 0, 256));
+        CHECK(events.empty());
+    }
+}
+
+TEST_CASE("VoicePool state events")
+{
+    deepnote::VoicePool<16>     pool;
+    deepnote::StateEventQueue<> events;
+
+    std::vector<deepnote::DeepnoteVoice *> voices;
+    for(int v = 0; v < 12; ++v)
+    {
+        auto *voice = pool.allocate();
+        init_voice(*voice, 2, nt::OscillatorFrequency(100.f + v * 10.f), sample_rate,
+                   nt::OscillatorFrequency(5.f + v));
+        voice->set_target_frequency(nt::OscillatorFrequency(1000.f));
+        voices.push_back(voice);
+    }
+
+    //  the host learns each voice has arrived from the queue alone
+    std::vector<int> arrivals(16, 0);
+    float            out[128];
+    for(int block = 0; block < 100; ++block)
+    {
+        pool.process_block(out, 128, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f),
+                           events);
+        for(const auto &event : drain(events))
+        {
+            REQUIRE(event.voice_id < 16);
+            CHECK(event.sample_position >= pool.get_sample_position() - 128);
+            CHECK(event.sample_position < pool.get_sample_position());
+            if(event.state == deepnote::DeepnoteVoiceBase::AT_TARGET)
+            {
+                CHECK(pool.get_voice(event.voice_id).is_at_target());
+                ++arrivals[event.voice_id];
+            }
+        }
+    }
+
+    CHECK(pool.get_sample_position() == 100 * 128);
+    CHECK(events.get_dropped() == 0);
+    for(const auto *voice : voices)
+    {
+        CHECK(voice->is_at_target());
+        CHECK(arrivals[pool.get_index(voice)] == 1);
+    }
+}
@@ -0,0 +1,176 @@
+#include "voice/transittiming.hpp"
+#include <cmath>
+#include <doctest/doctest.h>
+
+namespace nt = deepnote::nt;
+
+namespace
+{
+const nt::SampleRate sample_rate{48000};
+
+uint64_t render_until_target(deepnote::DeepnoteVoice &voice, const nt::AnimationMultiplier multiplier,
+                             const nt::ControlPoint1 cp1, const nt::ControlPoint2 cp2, const uint64_t limit)
+{
+    uint64_t samples{0};
+    while(!voice.is_at_target() && samples < limit)
+    {
+        process_voice(voice, multiplier, cp1, cp2);
+        ++samples;
+    }
+    return samples;
+}
+} // namespace
+
+TEST_CASE("samples_until_target")
+{
+    struct Case
+    {
+        float start;
+        float target;
+        float lfo_frequency;
+        float multiplier;
+        float cp1;
+        float cp2;
+        bool  pitch;
+    };
+    const Case cases[] = {
+        {200.f, 1200.f, 1.f, 1.f, 0.08f, 0.5f, false},  {1200.f, 200.f, 1.f, 1.f, 0.08f, 0.5f, false},
+        {40.f, 8000.f, 0.5f, 2.f, 0.f, 1.f, false},     {8000.f, 40.f, 0.1f, 1.f, 0.9f, 0.1f, false},
+        {100.f, 101.5f, 2.f, 1.f, 0.3f, 0.6f, false},   {440.f, 440.5f, 1.f, 1.f, 0.08f, 0.5f, false},
+        {300.f, 600.f, 0.05f, 1.f, 1.f / 3, 2.f / 3, false}, {55.f, 3520.f, 0.5f, 1.f, 0.08f, 0.5f, true},
+        {3520.f, 55.f, 0.5f, 3.f, 0.5f, 0.5f, true},    {200.f, 400.f, 1.f, 1.f, 1.4f, -0.4f, false},
+        {200.f, 400.f, 1.f, 1.f, -0.2f, 0.5f, false},
+    };
+
+    for(const auto &c : cases)
+    {
+        CAPTURE(c.start);
+        CAPTURE(c.target);
+        CAPTURE(c.lfo_frequency);
+        CAPTURE(c.cp1);
+        CAPTURE(c.cp2);
+        CAPTURE(c.pitch);
+
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 1, nt::OscillatorFrequency(c.start), sample_rate, nt::OscillatorFrequency(c.lfo_frequency));
+        voice.set_transit_mode(c.pitch ? deepnote::DeepnoteVoiceBase::PITCH_TRANSIT
+                                       : deepnote::DeepnoteVoiceBase::LINEAR_TRANSIT);
+        voice.set_target_frequency(nt::OscillatorFrequency(c.target));
+
+        const nt::AnimationMultiplier multiplier(c.multiplier);
+        const nt::ControlPoint1       cp1(c.cp1);
+        const nt::ControlPoint2       cp2(c.cp2);
+
+        //  predicted before the transit starts and again partway through
+        const uint64_t predicted = deepnote::samples_until_target(voice, multiplier, cp1, cp2);
+        REQUIRE(predicted != deepnote::constants::NEVER_AT_TARGET);
+
+        const uint64_t partway = predicted / 3;
+        const uint64_t first   = render_until_target(voice, multiplier, cp1, cp2, partway);
+        const uint64_t later   = deepnote::samples_until_target(voice, multiplier, cp1, cp2);
+        const uint64_t actual  = first + render_until_target(voice, multiplier, cp1, cp2, 2 * predicted + 100);
+
+        CHECK(voice.is_at_target());
+        CHECK(std::abs(static_cast<int64_t>(predicted - actual)) <= 1);
+        CHECK(std::abs(static_cast<int64_t>(first + later - actual)) <= 1);
+        CHECK(deepnote::samples_until_target(voice, multiplier, cp1, cp2) == 0);
+    }
+}
+
+TEST_CASE("samples_until_target edge cases")
+{
+    deepnote::DeepnoteVoice voice;
+    init_voice(voice, 1, nt::OscillatorFrequency(200.f), sample_rate, nt::OscillatorFrequency(1.f));
+    voice.set_target_frequency(nt::OscillatorFrequency(400.f));
+
+    SUBCASE("A stopped LFO never arrives")
+    {
+        CHECK(deepnote::samples_until_target(voice, nt::AnimationMultiplier(0.f), nt::ControlPoint1(0.08f),
+                                             nt::ControlPoint2(0.5f)) == deepnote::constants::NEVER_AT_TARGET);
+    }
+
+    SUBCASE("Slow transits follow the LFO's rounding")
+    {
+        //  ten minutes at 48kHz, where dividing the distance by the increment
+        //  is out by about 90 seconds
+        init_voice(voice, 1, nt::OscillatorFrequency(200.f), sample_rate, nt::OscillatorFrequency(1.f / 600));
+        voice.set_target_frequency(nt::OscillatorFrequency(400.f));
+        const nt::AnimationMultiplier multiplier(1.f);
+        const nt::ControlPoint1       cp1(1.f / 3);
+        const nt::ControlPoint2       cp2(2.f / 3);
+
+        const uint64_t predicted = deepnote::samples_until_target(voice, multiplier, cp1, cp2);
+        const uint64_t actual    = render_until_target(voice, multiplier, cp1, cp2, UINT64_MAX);
+        CHECK(std::abs(static_cast<int64_t>(predicted - actual)) <= 1);
+    }
+
+    SUBCASE("Retargets restart the prediction")
+    {
+        const nt::AnimationMultiplier multiplier(1.f);
+        const nt::ControlPoint1       cp1(0.08f);
+        const nt::ControlPoint2       cp2(0.5f);
+        render_until_target(voice, multiplier, cp1, cp2, 10000);
+        REQUIRE(!voice.is_at_target());
+
+        voice.set_target_frequency(nt::OscillatorFrequency(100.f));
+        const uint64_t predicted = deepnote::samples_until_target(voice, multiplier, cp1, cp2);
+        const uint64_t actual    = render_until_target(voice, multiplier, cp1, cp2, 100000);
+        CHECK(std::abs(static_cast<int64_t>(predicted - actual)) <= 1);
+    }
+}
+
+TEST_CASE("time_at_frequency")
+{
+    const nt::AnimationMultiplier multiplier(2.f);
+    const nt::ControlPoint1       cp1(0.08f);
+    const nt::ControlPoint2       cp2(0.5f);
+
+    for(const bool pitch : {false, true})
+    {
+        for(const float target : {1600.f, 50.f})
+        {
+            CAPTURE(pitch);
+            CAPTURE(target);
+
+            deepnote::DeepnoteVoice voice;
+            init_voice(voice, 1, nt::OscillatorFrequency(200.f), sample_rate, nt::OscillatorFrequency(0.5f));
+            voice.set_transit_mode(pitch ? deepnote::DeepnoteVoiceBase::PITCH_TRANSIT
+                                         : deepnote::DeepnoteVoiceBase::LINEAR_TRANSIT);
+            voice.set_target_frequency(nt::OscillatorFrequency(target));
+
+            const float probes[] = {200.f + (target - 200.f) * 0.25f, 200.f + (target - 200.f) * 0.5f,
+                                    200.f + (target - 200.f) * 0.9f};
+            float       expected[3];
+            for(size_t p = 0; p < 3; ++p)
+            {
+                expected[p] = deepnote::time_at_frequency(voice, nt::OscillatorFrequency(probes[p]), multiplier, cp1,
+                                                          cp2);
+            }
+            CHECK(expected[0] < expected[1]);
+            CHECK(expected[1] < expected[2]);
+            CHECK(deepnote::time_at_frequency(voice, nt::OscillatorFrequency(200.f), multiplier, cp1, cp2) == 0.f);
+            const nt::OscillatorFrequency beyond((target > 200.f) ? target * 2.f : target / 2.f);
+            CHECK(std::isinf(deepnote::time_at_frequency(voice, beyond, multiplier, cp1, cp2)));
+
+            //  with the LFO stopped only the start frequency is ever reached
+            const nt::AnimationMultiplier stopped(0.f);
+            CHECK(deepnote::time_at_frequency(voice, nt::OscillatorFrequency(200.f), stopped, cp1, cp2) == 0.f);
+            CHECK(std::isinf(
+                deepnote::time_at_frequency(voice, nt::OscillatorFrequency(probes[1]), stopped, cp1, cp2)));
+
+            //  the first sample at or past each probe frequency
+            size_t probe{0};
+            for(int i = 0; i < 48000 && probe < 3; ++i)
+            {
+                process_voice(voice, multiplier, cp1, cp2);
+                const float current = voice.get_current_frequency().get();
+                while(probe < 3 && ((target > 200.f) ? current >= probes[probe] : current <= probes[probe]))
+                {
+                    CHECK(std::abs(i - expected[probe] * sample_rate.get()) <= 1.5f);
+                    ++probe;
+                }
+            }
+            CHECK(probe == 3);
+        }
+    }
+}
@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 namespace nt = deepnote::nt;
 
@@ -195,3 +196,317 @@ TEST_CASE("DeepnoteVoice log target changed mid cycle then reset")
     }
     CHECK(voice.is_at_target());
 }
+
+TEST_CASE("BasicDeepnoteVoice oscillator capacity")
+{
+    const nt::SampleRate sample_rate{48000};
+
+    SUBCASE("Footprint follows capacity")
+    {
+        CHECK(deepnote::DeepnoteVoice::MAX_OSCILLATORS == deepnote::constants::DEFAULT_MAX_OSCILLATORS);
+        CHECK(deepnote::BasicDeepnoteVoice<3>::MAX_OSCILLATORS == 3);
+        CHECK(sizeof(deepnote::BasicDeepnoteVoice<3>) < sizeof(deepnote::DeepnoteVoice));
+    }
+
+    SUBCASE("Capacity is enforced")
+    {
+        deepnote::BasicDeepnoteVoice<2> voice;
+        CHECK_THROWS_AS(init_voice(voice, 3, nt::OscillatorFrequency(400.f), sample_rate, nt::OscillatorFrequency(1.f)),
+                        std::invalid_argument);
+        CHECK_NOTHROW(init_voice(voice, 2, nt::OscillatorFrequency(400.f), sample_rate, nt::OscillatorFrequency(1.f)));
+        CHECK(voice.get_oscillator_count() == 2);
+    }
+
+    SUBCASE("Full and partial banks render identically")
+    {
+        deepnote::BasicDeepnoteVoice<3> full;
+        deepnote::DeepnoteVoice         partial;
+
+        init_voice(full, 3, nt::OscillatorFrequency(400.f), sample_rate, nt::OscillatorFrequency(1.f));
+        init_voice(partial, 3, nt::OscillatorFrequency(400.f), sample_rate, nt::OscillatorFrequency(1.f));
+        full.set_target_frequency(nt::OscillatorFrequency(2000.f));
+        partial.set_target_frequency(nt::OscillatorFrequency(2000.f));
+
+        for(int i = 0; i < sample_rate.get(); i++)
+        {
+            const auto a =
+                process_voice(full, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+            const auto b =
+                process_voice(partial, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+            REQUIRE(a.get() == b.get());
+            REQUIRE(full.get_state() == partial.get_state());
+        }
+        CHECK(full.is_at_target());
+    }
+}
+
+TEST_CASE("DeepnoteVoice steady state")
+{
+    const nt::SampleRate    sample_rate{48000};
+    deepnote::DeepnoteVoice voice;
+    init_voice(voice, 6, nt::OscillatorFrequency(200.f), sample_rate, nt::OscillatorFrequency(4.f));
+    voice.set_target_frequency(nt::OscillatorFrequency(800.f));
+
+    CHECK_FALSE(voice.is_steady_state());
+    for(int i = 0; i < sample_rate.get() && !voice.is_at_target(); i++)
+    {
+        process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+        REQUIRE(voice.is_steady_state() == voice.is_at_target());
+    }
+    REQUIRE(voice.is_steady_state());
+
+    SUBCASE("Renders the same as the full path")
+    {
+        //  setting the state every sample keeps the copy on the full path
+        deepnote::DeepnoteVoice full_path(voice);
+        for(int i = 0; i < 4800; i++)
+        {
+            full_path.set_state(deepnote::DeepnoteVoice::AT_TARGET);
+            REQUIRE_FALSE(full_path.is_steady_state());
+            const auto expected = process_voice(full_path, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f),
+                                                nt::ControlPoint2(0.5f));
+            const auto actual =
+                process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+            REQUIRE(actual.get() == expected.get());
+        }
+    }
+
+    SUBCASE("Changes leave the steady state")
+    {
+        voice.detune_oscillators(nt::DetuneHz(5.f));
+        CHECK_FALSE(voice.is_steady_state());
+        process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+        CHECK(voice.is_steady_state());
+
+        voice.set_adaptive_antialiasing(false);
+        CHECK_FALSE(voice.is_steady_state());
+        process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+        CHECK(voice.is_steady_state());
+
+        voice.set_target_frequency(nt::OscillatorFrequency(300.f));
+        CHECK_FALSE(voice.is_steady_state());
+        process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+        CHECK_FALSE(voice.is_steady_state());
+        CHECK(voice.get_state() == deepnote::DeepnoteVoice::IN_TRANSIT_TO_TARGET);
+    }
+}
+
+TEST_CASE("DeepnoteVoice phase increments")
+{
+    const nt::SampleRate sample_rate{48000};
+
+    SUBCASE("Detuned increments match independently tuned oscillators")
+    {
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 5, nt::OscillatorFrequency(440.f), sample_rate, nt::OscillatorFrequency(1.f),
+                   nt::DetuneHz(3.f));
+        voice.set_adaptive_antialiasing(false);
+
+        std::array<deepnote::SawOscillator, 5> reference;
+        const float                            detune[] = {-6.f, -3.f, 3.f, 6.f, 9.f};
+        for(size_t i = 0; i < reference.size(); ++i)
+        {
+            reference[i].init(sample_rate.get());
+            reference[i].set_freq(440.f + detune[i]);
+        }
+
+        for(int i = 0; i < 4800; i++)
+        {
+            float expected{0.f};
+            for(auto &oscillator : reference)
+            {
+                expected += oscillator.process();
+            }
+            const auto actual =
+                process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+            REQUIRE(actual.get() == doctest::Approx(expected).epsilon(1e-3));
+        }
+    }
+
+    SUBCASE("Detune changes at target are applied")
+    {
+        deepnote::DeepnoteVoice voice;
+        deepnote::DeepnoteVoice retuned;
+        for(auto *v : {&voice, &retuned})
+        {
+            init_voice(*v, 4, nt::OscillatorFrequency(440.f), sample_rate, nt::OscillatorFrequency(1.f));
+            for(int i = 0; i < 100; i++)
+            {
+                process_voice(*v, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+            }
+        }
+        retuned.detune_oscillators(nt::DetuneHz(40.f));
+
+        bool differs{false};
+        for(int i = 0; i < 480; i++)
+        {
+            const auto a =
+                process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+            const auto b =
+                process_voice(retuned, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.08f), nt::ControlPoint2(0.5f));
+            differs = differs || (a.get() != b.get());
+        }
+        CHECK(differs);
+    }
+}
+
+TEST_CASE("DeepnoteVoice detune laws")
+{
+    const nt::SampleRate sample_rate{48000};
+
+    SUBCASE("Spread laws share their outermost steps")
+    {
+        for(const size_t count : {2u, 3u, 8u, 15u, 16u})
+        {
+            for(const auto spread : {deepnote::LINEAR_SPREAD, deepnote::EXPONENTIAL_SPREAD, deepnote::GOLDEN_SPREAD})
+            {
+                CAPTURE(count);
+                CAPTURE(spread);
+                const float low  = deepnote::detune_step(spread, 0, count);
+                const float high = deepnote::detune_step(spread, count - 1, count);
+                CHECK(low == doctest::Approx(deepnote::detune_step(deepnote::LINEAR_SPREAD, 0, count)));
+                CHECK(high == doctest::Approx(deepnote::detune_step(deepnote::LINEAR_SPREAD, count - 1, count)));
+                for(size_t i = 1; i < count; ++i)
+                {
+                    REQUIRE(deepnote::detune_step(spread, i, count) > deepnote::detune_step(spread, i - 1, count));
+                }
+            }
+        }
+        CHECK(deepnote::detune_step(deepnote::GOLDEN_SPREAD, 0, 1) == 0.f);
+        CHECK(deepnote::detune_step(deepnote::EXPONENTIAL_SPREAD, 3, 8) == doctest::Approx(-0.5f));
+    }
+
+    SUBCASE("Hz detune is linear in Hz")
+    {
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 4, nt::OscillatorFrequency(440.f), sample_rate, nt::OscillatorFrequency(1.f),
+                   nt::DetuneHz(5.f));
+        const float expected[] = {430.f, 435.f, 445.f, 450.f};
+        for(size_t i = 0; i < 4; ++i)
+        {
+            CHECK(voice.get_oscillator_frequency(i).get() == doctest::Approx(expected[i]));
+        }
+    }
+
+    SUBCASE("Cents detune keeps its interval at every frequency")
+    {
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 5, nt::OscillatorFrequency(100.f), sample_rate, nt::OscillatorFrequency(1.f));
+        voice.detune_oscillators(nt::DetuneCents(10.f), deepnote::GOLDEN_SPREAD);
+
+        std::vector<float> ratios;
+        for(size_t i = 0; i < 5; ++i)
+        {
+            ratios.push_back(voice.get_oscillator_frequency(i).get() / 100.f);
+        }
+        CHECK(ratios.back() == doctest::Approx(deepnote::cents_to_ratio(30.f)));
+
+        voice.set_current_frequency(nt::OscillatorFrequency(8000.f));
+        for(size_t i = 0; i < 5; ++i)
+        {
+            CHECK(voice.get_oscillator_frequency(i).get() / 8000.f == doctest::Approx(ratios[i]));
+        }
+    }
+
+    SUBCASE("Ratio detune matches cents detune")
+    {
+        deepnote::DeepnoteVoice cents;
+        deepnote::DeepnoteVoice ratio;
+        for(auto *v : {&cents, &ratio})
+        {
+            init_voice(*v, 8, nt::OscillatorFrequency(220.f), sample_rate, nt::OscillatorFrequency(1.f));
+        }
+        cents.detune_oscillators(nt::DetuneCents(5.f), deepnote::EXPONENTIAL_SPREAD);
+        ratio.detune_oscillators(nt::DetuneRatio(deepnote::cents_to_ratio(5.f)), deepnote::EXPONENTIAL_SPREAD);
+        for(size_t i = 0; i < 8; ++i)
+        {
+            CHECK(ratio.get_oscillator_frequency(i).get() ==
+                  doctest::Approx(cents.get_oscillator_frequency(i).get()).epsilon(1e-6));
+        }
+    }
+
+    SUBCASE("Cents increments match independently tuned oscillators")
+    {
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 4, nt::OscillatorFrequency(1000.f), sample_rate, nt::OscillatorFrequency(1.f));
+        voice.set_adaptive_antialiasing(false);
+        voice.detune_oscillators(nt::DetuneCents(20.f));
+
+        std::array<deepnote::SawOscillator, 4> oscillators;
+        for(size_t i = 0; i < 4; ++i)
+        {
+            oscillators[i].init(sample_rate.get());
+            const float cents = deepnote::detune_step(deepnote::LINEAR_SPREAD, i, 4) * 20.f;
+            oscillators[i].set_freq(1000.f * deepnote::cents_to_ratio(cents));
+        }
+        for(int n = 0; n < 480; n++)
+        {
+            float expected{0.f};
+            for(auto &oscillator : oscillators)
+            {
+                expected += oscillator.process();
+            }
+            REQUIRE(voice.process_oscillators().get() == doctest::Approx(expected).epsilon(1e-4));
+        }
+    }
+}
+
+TEST_CASE("DeepnoteVoice pitch transit")
+{
+    const nt::SampleRate sample_rate{48000};
+    //  control points on the straight line make the shaped value equal the LFO ramp
+    const nt::ControlPoint1 cp1(1.f / 3.f);
+    const nt::ControlPoint2 cp2(2.f / 3.f);
+
+    SUBCASE("Linear is the default")
+    {
+        deepnote::DeepnoteVoice voice;
+        CHECK(voice.get_transit_mode() == deepnote::DeepnoteVoice::LINEAR_TRANSIT);
+    }
+
+    SUBCASE("Glides in equal intervals")
+    {
+        for(const auto freqs : {std::array<float, 2>{100.f, 1600.f}, std::array<float, 2>{1600.f, 100.f}})
+        {
+            CAPTURE(freqs[0]);
+            deepnote::DeepnoteVoice voice;
+            init_voice(voice, 2, nt::OscillatorFrequency(freqs[0]), sample_rate, nt::OscillatorFrequency(1.f));
+            voice.set_transit_mode(deepnote::DeepnoteVoice::PITCH_TRANSIT);
+            voice.set_target_frequency(nt::OscillatorFrequency(freqs[1]));
+
+            //  four octaves over one second, so a quarter second is one octave
+            int samples{0};
+            for(; samples < sample_rate.get() && !voice.is_at_target(); ++samples)
+            {
+                process_voice(voice, nt::AnimationMultiplier(1.f), cp1, cp2);
+                if(samples == 12000)
+                {
+                    const float expected = freqs[0] * std::exp2(0.25f * std::log2(freqs[1] / freqs[0]));
+                    CHECK(voice.get_current_frequency().get() == doctest::Approx(expected).epsilon(1e-4));
+                }
+                if(samples == 24000)
+                {
+                    const float expected = std::sqrt(freqs[0] * freqs[1]);
+                    CHECK(voice.get_current_frequency().get() == doctest::Approx(expected).epsilon(1e-4));
+                }
+            }
+            CHECK(voice.is_at_target());
+            CHECK(voice.get_current_frequency().get() == freqs[1]);
+            CHECK(samples > 47000);
+        }
+    }
+
+    SUBCASE("Transits from 0Hz")
+    {
+        deepnote::DeepnoteVoice voice;
+        init_voice(voice, 2, nt::OscillatorFrequency(0.f), sample_rate, nt::OscillatorFrequency(1.f));
+        voice.set_transit_mode(deepnote::DeepnoteVoice::PITCH_TRANSIT);
+        voice.set_target_frequency(nt::OscillatorFrequency(440.f));
+        for(int i = 0; i < sample_rate.get() && !voice.is_at_target(); ++i)
+        {
+            process_voice(voice, nt::AnimationMultiplier(1.f), cp1, cp2);
+            REQUIRE(std::isfinite(voice.get_current_frequency().get()));
+        }
+        CHECK(voice.is_at_target());
+    }
+}
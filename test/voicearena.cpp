@@ -0,0 +1,112 @@
+#include "ensemble/ensemble.hpp"
+#include "ensemble/voicearena.hpp"
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <type_traits>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+TEST_CASE("VoiceArena")
+{
+    using Arena = deepnote::VoiceArena<>;
+
+    SUBCASE("Voices carry no vtable pointer")
+    {
+        CHECK_FALSE(std::is_polymorphic<deepnote::DeepnoteVoice>::value);
+    }
+
+    SUBCASE("Every voice starts on its own cache line")
+    {
+        Arena arena(3, 5);
+        CHECK(Arena::get_voice_stride() % deepnote::constants::CACHE_LINE_SIZE == 0);
+        CHECK(Arena::get_voice_stride() >= sizeof(deepnote::DeepnoteVoice));
+        CHECK(Arena::get_voice_stride() < sizeof(deepnote::DeepnoteVoice) + deepnote::constants::CACHE_LINE_SIZE);
+
+        for(size_t i = 0; i < arena.get_voice_count(); ++i)
+        {
+            REQUIRE(reinterpret_cast<uintptr_t>(&arena[i]) % deepnote::constants::CACHE_LINE_SIZE == 0);
+        }
+    }
+
+    SUBCASE("Partitions are contiguous and padded apart")
+    {
+        Arena arena(4, 8);
+        CHECK(arena.get_partition_count() == 4);
+        CHECK(arena.get_voice_count() == 32);
+
+        size_t index{0};
+        for(size_t p = 0; p < arena.get_partition_count(); ++p)
+        {
+            const auto partition = arena.partition(p);
+            CHECK(partition.size() == 8);
+            for(auto &voice : partition)
+            {
+                REQUIRE(&voice == &arena[index++]);
+            }
+            if(p > 0)
+            {
+                const auto *previous_end = reinterpret_cast<const unsigned char *>(&arena[p * 8 - 1]) +
+                                           sizeof(deepnote::DeepnoteVoice);
+                const auto *next_begin = reinterpret_cast<const unsigned char *>(&*partition.begin());
+                CHECK(next_begin - previous_end >=
+                      static_cast<std::ptrdiff_t>(deepnote::constants::ARENA_PARTITION_PADDING));
+            }
+        }
+        CHECK_THROWS_AS(arena.partition(4), std::invalid_argument);
+    }
+
+    SUBCASE("Size reporting")
+    {
+        Arena arena(2, 10);
+        CHECK(arena.get_voice_bytes() == 20 * Arena::get_voice_stride());
+        CHECK(arena.get_padding_bytes() == 20 * (Arena::get_voice_stride() - sizeof(deepnote::DeepnoteVoice)) +
+                                               2 * deepnote::constants::ARENA_PARTITION_PADDING);
+        CHECK(arena.get_reserved_bytes() >= arena.get_voice_bytes() + 2 * deepnote::constants::ARENA_PARTITION_PADDING);
+        CHECK_FALSE(arena.is_huge_page_advised());
+    }
+
+    SUBCASE("Huge page arenas are usable whether or not the kernel grants them")
+    {
+        Arena arena(2, 100, Arena::HUGE_PAGES);
+        CHECK(arena.get_reserved_bytes() >= arena.get_voice_bytes());
+        CHECK(reinterpret_cast<uintptr_t>(&arena[0]) % deepnote::constants::CACHE_LINE_SIZE == 0);
+#if defined(__linux__)
+        //  transparent huge pages only back aligned extents
+        CHECK(reinterpret_cast<uintptr_t>(&arena[0]) % deepnote::constants::HUGE_PAGE_SIZE == 0);
+#endif
+        init_voice(arena[199], 2, nt::OscillatorFrequency(100.f), nt::SampleRate(48000.f),
+                   nt::OscillatorFrequency(1.f));
+        CHECK(arena[199].get_current_frequency().get() == 100.f);
+    }
+
+    SUBCASE("Partitions render like any other ensemble")
+    {
+        Arena                                  arena(2, 3);
+        std::array<deepnote::DeepnoteVoice, 3> reference;
+        for(size_t i = 0; i < reference.size(); ++i)
+        {
+            for(auto *voice : {&reference[i], &*std::next(arena.partition(1).begin(), i)})
+            {
+                init_voice(*voice, 4, nt::OscillatorFrequency(100.f * (i + 1)), nt::SampleRate(48000.f),
+                           nt::OscillatorFrequency(1.f));
+                voice->set_target_frequency(nt::OscillatorFrequency(800.f));
+            }
+        }
+
+        std::vector<float> expected(256);
+        std::vector<float> actual(expected.size());
+        process_ensemble_block(reference.begin(), reference.end(), expected.data(), expected.size(),
+                               nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.25f), nt::ControlPoint2(0.75f));
+        const auto partition = arena.partition(1);
+        process_ensemble_block(partition.begin(), partition.end(), actual.data(), actual.size(),
+                               nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.25f), nt::ControlPoint2(0.75f));
+        CHECK(actual == expected);
+    }
+
+    SUBCASE("Empty arenas are rejected")
+    {
+        CHECK_THROWS_AS(Arena(0, 4), std::invalid_argument);
+        CHECK_THROWS_AS(Arena(4, 0), std::invalid_argument);
+    }
+}
@@ -0,0 +1,153 @@
+#include "ensemble/ensemble.hpp"
+#include "ensemble/voicepool.hpp"
+#include <doctest/doctest.h>
+#include <set>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+namespace
+{
+const nt::SampleRate sample_rate{48000.f};
+
+void start_voice(deepnote::DeepnoteVoice *voice, const float start, const float target)
+{
+    init_voice(*voice, 4, nt::OscillatorFrequency(start), sample_rate, nt::OscillatorFrequency(1.f));
+    voice->set_target_frequency(nt::OscillatorFrequency(target));
+}
+
+void render(deepnote::VoicePool<4> &pool, const size_t count)
+{
+    std::vector<float> out(count);
+    pool.process_block(out.data(), count, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.1f),
+                       nt::ControlPoint2(0.9f));
+}
+} // namespace
+
+TEST_CASE("VoicePool")
+{
+    deepnote::VoicePool<4> pool;
+
+    SUBCASE("Allocates distinct voices until full")
+    {
+        std::set<deepnote::DeepnoteVoice *> allocated;
+        for(size_t i = 0; i < pool.capacity(); ++i)
+        {
+            auto *voice = pool.allocate();
+            REQUIRE(voice != nullptr);
+            CHECK(pool.is_active(voice));
+            allocated.insert(voice);
+        }
+        CHECK(allocated.size() == pool.capacity());
+        CHECK(pool.get_active_count() == pool.capacity());
+    }
+
+    SUBCASE("Released voices are reused")
+    {
+        auto *first  = pool.allocate();
+        auto *second = pool.allocate();
+        pool.release(first);
+        CHECK_FALSE(pool.is_active(first));
+        CHECK(pool.is_active(second));
+        CHECK(pool.get_active_count() == 1);
+
+        CHECK(pool.allocate() == first);
+        CHECK(pool.get_active_count() == 2);
+    }
+
+    SUBCASE("Releasing twice or releasing a foreign voice is ignored")
+    {
+        deepnote::DeepnoteVoice foreign;
+        auto                   *voice = pool.allocate();
+        pool.release(voice);
+        pool.release(voice);
+        pool.release(&foreign);
+        CHECK(pool.get_active_count() == 0);
+        CHECK_FALSE(pool.is_active(&foreign));
+        CHECK(pool.get_level(&foreign) == 0.f);
+    }
+
+    SUBCASE("Iterates only active voices")
+    {
+        auto *a = pool.allocate();
+        auto *b = pool.allocate();
+        auto *c = pool.allocate();
+        pool.release(b);
+
+        std::set<deepnote::DeepnoteVoice *> visited;
+        for(auto &voice : pool)
+        {
+            visited.insert(&voice);
+        }
+        CHECK(visited == std::set<deepnote::DeepnoteVoice *>{a, c});
+    }
+
+    SUBCASE("Steals the oldest voice")
+    {
+        pool.set_steal_policy(deepnote::VoicePool<4>::STEAL_OLDEST);
+        std::vector<deepnote::DeepnoteVoice *> voices;
+        for(size_t i = 0; i < pool.capacity(); ++i)
+        {
+            voices.push_back(pool.allocate());
+        }
+        CHECK(pool.allocate() == voices[0]);
+        CHECK(pool.allocate() == voices[1]);
+        CHECK(pool.get_active_count() == pool.capacity());
+    }
+
+    SUBCASE("Steals the quietest voice")
+    {
+        pool.set_steal_policy(deepnote::VoicePool<4>::STEAL_QUIETEST);
+        std::vector<deepnote::DeepnoteVoice *> voices;
+        for(size_t i = 0; i < pool.capacity(); ++i)
+        {
+            voices.push_back(pool.allocate());
+            start_voice(voices.back(), 100.f, 200.f);
+        }
+
+        //  a single oscillator voice peaks lower than the four oscillator voices
+        init_voice(*voices[2], 1, nt::OscillatorFrequency(100.f), sample_rate, nt::OscillatorFrequency(1.f));
+        render(pool, 4800);
+        CHECK(pool.get_level(voices[2]) < pool.get_level(voices[0]));
+        CHECK(pool.allocate() == voices[2]);
+    }
+
+    SUBCASE("Steals the voice closest to target")
+    {
+        pool.set_steal_policy(deepnote::VoicePool<4>::STEAL_CLOSEST_TO_TARGET);
+        std::vector<deepnote::DeepnoteVoice *> voices;
+        for(size_t i = 0; i < pool.capacity(); ++i)
+        {
+            voices.push_back(pool.allocate());
+            start_voice(voices.back(), 100.f, 1000.f);
+        }
+        voices[3]->set_current_frequency(nt::OscillatorFrequency(900.f));
+        voices[3]->set_state(deepnote::DeepnoteVoice::IN_TRANSIT_TO_TARGET);
+        CHECK(pool.allocate() == voices[3]);
+
+        voices[1]->set_state(deepnote::DeepnoteVoice::AT_TARGET);
+        CHECK(pool.allocate() == voices[1]);
+    }
+
+    SUBCASE("Block render matches the ensemble render of the active voices")
+    {
+        deepnote::VoicePool<4> reference;
+        for(auto *p : {&pool, &reference})
+        {
+            for(size_t i = 0; i < 3; ++i)
+            {
+                start_voice(p->allocate(), 50.f * (i + 1), 500.f);
+            }
+        }
+        pool.release(&*pool.begin());
+        reference.release(&*reference.begin());
+
+        std::vector<float> expected(512);
+        std::vector<float> actual(512);
+        process_ensemble_block(reference.begin(), reference.end(), expected.data(), expected.size(),
+                               nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.1f), nt::ControlPoint2(0.9f));
+        pool.process_block(actual.data(), actual.size(), nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.1f),
+                           nt::ControlPoint2(0.9f));
+        CHECK(actual == expected);
+    }
+}
@@ -0,0 +1,116 @@
+#include "analysis/spectrum.hpp"
+#include "oscillators/sawoscillator.hpp"
+#include "oscillators/wavetable.hpp"
+#include "voice/deepnotevoice.hpp"
+#include <cmath>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace nt = deepnote::nt;
+
+using deepnote::analysis::magnitude_at;
+
+namespace
+{
+std::vector<float> render_wavetable(const float freq, const float sample_rate, const size_t count)
+{
+    deepnote::SawOscillator osc;
+    osc.init(sample_rate);
+    osc.set_freq(freq);
+
+    std::vector<float> out(count);
+    for(auto &sample : out)
+    {
+        sample = osc.process(deepnote::SawWavetable::shared());
+    }
+    return out;
+}
+
+std::vector<float> render_polyblep(const float freq, const float sample_rate, const size_t count)
+{
+    deepnote::SawOscillator osc;
+    osc.init(sample_rate);
+    osc.set_freq(freq);
+
+    std::vector<float> out(count);
+    for(auto &sample : out)
+    {
+        sample = osc.process();
+    }
+    return out;
+}
+} // namespace
+
+TEST_CASE("SawWavetable")
+{
+    const auto &table = deepnote::SawWavetable::shared();
+
+    SUBCASE("Shared instance is built once")
+    {
+        CHECK(&table == &deepnote::SawWavetable::shared());
+    }
+
+    SUBCASE("Low levels approximate a falling sawtooth")
+    {
+        const float phase_inc = 20.f / 48000.f;
+        CHECK(table.read(0.25f, phase_inc) == doctest::Approx(0.25f).epsilon(0.01));
+        CHECK(table.read(0.5f, phase_inc) == doctest::Approx(0.f).epsilon(0.01));
+        CHECK(table.read(0.75f, phase_inc) == doctest::Approx(-0.25f).epsilon(0.01));
+    }
+
+    SUBCASE("Top level is a sine")
+    {
+        const float phase_inc = 0.4f;
+        CHECK(table.read(0.25f, phase_inc) == doctest::Approx(1.f / 3.14159265f).epsilon(0.001));
+        CHECK(table.read(0.f, phase_inc) == doctest::Approx(0.f).epsilon(0.001));
+    }
+
+    SUBCASE("Crossfade is continuous across mip levels")
+    {
+        float previous = table.read(0.3f, 100.f / 48000.f);
+        for(float freq = 101.f; freq < 12000.f; freq += 1.f)
+        {
+            const float current = table.read(0.3f, freq / 48000.f);
+            REQUIRE(std::abs(current - previous) < 0.01f);
+            previous = current;
+        }
+    }
+
+    SUBCASE("Phase at the end of the table is readable")
+    {
+        CHECK(std::isfinite(table.read(1.f, 440.f / 48000.f)));
+    }
+
+    SUBCASE("Aliases less than PolyBLEP near Nyquist")
+    {
+        const float sample_rate = 48000.f;
+        const float freq        = 7000.f;
+        const float alias       = sample_rate - 7.f * freq;
+
+        const auto wavetable = render_wavetable(freq, sample_rate, 8192);
+        const auto polyblep  = render_polyblep(freq, sample_rate, 8192);
+
+        CHECK(magnitude_at(wavetable, alias, sample_rate) < 0.1f * magnitude_at(polyblep, alias, sample_rate));
+    }
+}
+
+TEST_CASE("DeepnoteVoice wavetable oscillators")
+{
+    const nt::SampleRate    sample_rate{48000.f};
+    deepnote::DeepnoteVoice voice;
+    init_voice(voice, 4, nt::OscillatorFrequency(30.f), sample_rate, nt::OscillatorFrequency(2.f));
+
+    CHECK(voice.get_wavetable() == nullptr);
+    voice.set_wavetable(&deepnote::SawWavetable::shared());
+    CHECK(voice.get_wavetable() == &deepnote::SawWavetable::shared());
+
+    voice.set_target_frequency(nt::OscillatorFrequency(12000.f));
+    for(int i = 0; i < 48000; ++i)
+    {
+        const auto out =
+            process_voice(voice, nt::AnimationMultiplier(1.f), nt::ControlPoint1(0.1f), nt::ControlPoint2(0.9f));
+        REQUIRE(std::isfinite(out.get()));
+        REQUIRE(std::abs(out.get()) <= 4.f * 0.6f);
+    }
+    CHECK(voice.is_at_target());
+}